@@ -2,7 +2,12 @@
 #include "main.h"
 #include "pros/llemu.hpp"
 #include "pros/rtos.hpp"
+#include "okapi/squiggles/squiggles.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <deque>
+#include <functional>
 #include <mutex>
 #include <numeric>
 
@@ -119,11 +124,383 @@ public:
 		return d;
 	}
 
+	inline double get_kp() {
+		return kp;
+	}
+
+	inline double get_kb() {
+		return kb;
+	}
+
+	inline double get_kf() {
+		return kf;
+	}
+
 	inline static std::unique_ptr<PID> create(double ikp, double iki, double ikd, double ikb, double ikf, unsigned long iinterval) {
 		return std::make_unique<PID>(ikp, iki, ikd, ikb, ikf, iinterval);
 	}
 };
 
+// Open-loop voltage to hold a velocity and acceleration: ks mV to break
+// static friction, kv mV per unit of velocity and ka mV per unit of
+// acceleration. The friction term ramps in over the first band units of
+// velocity so it does not chatter as the velocity crosses zero.
+class Feedforward {
+	double ks;
+	double kv;
+	double ka;
+	double band;
+
+public:
+	Feedforward(double iks, double ikv, double ika, double iband = 0) :
+	ks(iks), kv(ikv), ka(ika), band(iband) {
+	}
+
+	struct Sample {
+		double voltage;
+		double velocity;
+		double acceleration;
+	};
+
+	inline double calculate(double velocity, double acceleration = 0) {
+		double friction = 0;
+		if (band > 0) {
+			friction = ks * std::clamp(velocity / band, -1.0, 1.0);
+		} else if (velocity != 0 || acceleration != 0) {
+			friction = std::copysign(ks, velocity != 0 ? velocity : acceleration);
+		}
+		return friction + kv * velocity + ka * acceleration;
+	}
+
+	inline double get_ks() {
+		return ks;
+	}
+
+	inline double get_kv() {
+		return kv;
+	}
+
+	inline double get_ka() {
+		return ka;
+	}
+
+	inline static std::unique_ptr<Feedforward> create(double iks, double ikv, double ika, double iband = 0) {
+		return std::make_unique<Feedforward>(iks, ikv, ika, iband);
+	}
+
+	// Least-squares ks, kv and ka for voltage = ks * sign(velocity) +
+	// kv * velocity + ka * acceleration over logged samples, solving the
+	// 3x3 normal equations directly. Samples at a standstill say nothing
+	// about which way friction acts and are left out.
+	inline static std::unique_ptr<Feedforward> fit(const std::vector<Sample>& samples, double iband = 0, double still = 1) {
+		double a[3][4] = {};
+		for (auto& sample : samples) {
+			if (std::abs(sample.velocity) < still) {
+				continue;
+			}
+			double row[3] = {std::copysign(1.0, sample.velocity), sample.velocity, sample.acceleration};
+			for (int i = 0; i < 3; i++) {
+				for (int j = 0; j < 3; j++) {
+					a[i][j] += row[i] * row[j];
+				}
+				a[i][3] += row[i] * sample.voltage;
+			}
+		}
+		// Gauss-Jordan with partial pivoting.
+		for (int col = 0; col < 3; col++) {
+			int pivot = col;
+			for (int i = col + 1; i < 3; i++) {
+				if (std::abs(a[i][col]) > std::abs(a[pivot][col])) {
+					pivot = i;
+				}
+			}
+			std::swap(a[col], a[pivot]);
+			if (std::abs(a[col][col]) < 1e-9) {
+				return nullptr;
+			}
+			for (int i = 0; i < 3; i++) {
+				if (i != col) {
+					double factor = a[i][col] / a[col][col];
+					for (int j = col; j < 4; j++) {
+						a[i][j] -= factor * a[col][j];
+					}
+				}
+			}
+		}
+		return create(a[0][3] / a[0][0], a[1][3] / a[1][1], a[2][3] / a[2][2], iband);
+	}
+};
+
+// Closes the loop on one side of the drive's speed as read off its tracking
+// wheel: the feedforward gives the voltage the target speed and acceleration
+// should take and a PI on the speed error makes up what the model misses.
+class VelocityController {
+	std::unique_ptr<Feedforward> feedforward;
+	double kp;
+	double ki;
+	double integral = 0;
+
+public:
+	static constexpr double INTEGRAL_MAX = 3000;   // mV
+	static constexpr double INTEGRAL_BAND = 15;    // cm/s of error beyond which it stops integrating
+
+	VelocityController(std::unique_ptr<Feedforward> ifeedforward, double ikp, double iki) :
+	feedforward(std::move(ifeedforward)), kp(ikp), ki(iki) {
+	}
+
+	// Target and measured speed in cm/s, acceleration in cm/s^2, dt in s.
+	inline double step(double velocity, double acceleration, double measured, double dt) {
+		double error = velocity - measured;
+		// Only near the target, so a step in the target does not wind it up.
+		if (std::abs(error) < INTEGRAL_BAND) {
+			integral = std::clamp(integral + ki * error * dt, -INTEGRAL_MAX, INTEGRAL_MAX);
+		}
+		return std::clamp(feedforward->calculate(velocity, acceleration) + kp * error + integral, -12000.0, 12000.0);
+	}
+
+	inline void reset() {
+		integral = 0;
+	}
+
+	inline static std::unique_ptr<VelocityController> create(std::unique_ptr<Feedforward> ifeedforward, double ikp, double iki) {
+		return std::make_unique<VelocityController>(std::move(ifeedforward), ikp, iki);
+	}
+};
+
+// Model-based speed controller for a first-order plant,
+//   speed[k+1] = a * speed[k] + b * (voltage[k] + load[k])
+// one step per interval, as designed by sim/fit_lqr.py. A steady-state Kalman
+// filter estimates the speed and the load (friction, model error, discs)
+// from two readings, and the output cancels the load, holds the target and
+// adds the LQR gain k on what is left of the speed error.
+class StateSpace {
+	double a;
+	double b;
+	double k;
+	double sensor_speed;   // Kalman gains from each reading's innovation
+	double motor_speed;
+	double sensor_load;
+	double motor_load;
+
+	double speed = 0;
+	double load = 0;
+	double output = 0;
+
+public:
+	StateSpace(double ia, double ib, double ik, double isensor_speed, double imotor_speed, double isensor_load, double imotor_load) :
+	a(ia), b(ib), k(ik), sensor_speed(isensor_speed), motor_speed(imotor_speed), sensor_load(isensor_load), motor_load(imotor_load) {
+	}
+
+	// Called once an interval with both readings; returns the voltage,
+	// clamped as the motors will apply it so the next prediction holds.
+	// boost is voltage added on top for a load known to be coming.
+	inline double step(double target, double sensor, double motor, double boost = 0) {
+		double predicted = a * speed + b * (output + load);
+		double sensor_error = sensor - predicted;
+		double motor_error = motor - predicted;
+		speed = predicted + sensor_speed * sensor_error + motor_speed * motor_error;
+		load += sensor_load * sensor_error + motor_load * motor_error;
+
+		double hold = target * (1 - a) / b - load;
+		output = std::clamp(hold + k * (target - speed) + boost, 0.0, 12000.0);
+		return output;
+	}
+
+	inline void reset(double measured) {
+		speed = measured;
+		load = 0;
+		output = 0;
+	}
+
+	inline double get_speed() {
+		return speed;
+	}
+
+	inline double get_load() {
+		return load;
+	}
+
+	inline static std::unique_ptr<StateSpace> create(double ia, double ib, double ik, double isensor_speed, double imotor_speed, double isensor_load, double imotor_load) {
+		return std::make_unique<StateSpace>(ia, ib, ik, isensor_speed, imotor_speed, isensor_load, imotor_load);
+	}
+};
+
+// Time-optimal move of a distance under velocity, acceleration and jerk
+// limits, ending at rest: a trapezoid when max_jerk is 0, otherwise a
+// jerk-limited S-curve. Any units, as long as they agree; sample takes
+// seconds from the start. A move that starts already moving toward the end
+// joins the rest-to-rest curve where its speed matches, and one moving away
+// or too fast to stop in time brakes at max_acceleration first.
+class Profile {
+	double max_velocity;
+	double max_acceleration;
+	double distance;      // of the rest-to-rest part, always positive
+	double sign;
+	double velocity;      // cruise velocity actually reached
+	double acceleration;  // peak acceleration actually reached
+	double jerk;
+	double ramp = 0;      // s of jerk at each end of an acceleration phase
+	double accelerate;    // s to reach velocity
+	double cruise;        // s at velocity
+
+	double skip = 0;      // s of the rest-to-rest part a moving start joins at
+	double skipped = 0;   // and the distance it covers up to there
+	double brake = 0;     // s spent braking a start that has to turn round
+	double start = 0;     // start velocity when braking
+	double braked = 0;    // distance braking covers
+
+	// Time for the rest-to-rest part to reach v.
+	inline double time_to(double v) {
+		if (jerk <= 0) {
+			return v / acceleration;
+		}
+		if (v < acceleration * acceleration / jerk) {
+			return 2 * std::sqrt(v / jerk);
+		}
+		return v / acceleration + acceleration / jerk;
+	}
+
+	// Plans the rest-to-rest part over idistance.
+	inline void plan(double idistance) {
+		velocity = max_velocity;
+		acceleration = max_acceleration;
+		ramp = 0;
+		distance = std::abs(idistance);
+		sign = idistance < 0 ? -1 : 1;
+		// A short move has to settle for a slower cruise so speeding up and
+		// slowing down fit in the distance.
+		if (velocity * time_to(velocity) > distance) {
+			if (jerk <= 0) {
+				velocity = std::sqrt(distance * acceleration);
+			} else {
+				double lag = acceleration / jerk;
+				velocity = acceleration / 2 * (-lag + std::sqrt(lag * lag + 4 * distance / acceleration));
+				if (velocity < acceleration * lag) {
+					velocity = std::cbrt(distance * distance * jerk / 4);
+				}
+			}
+		}
+		accelerate = time_to(velocity);
+		if (jerk > 0) {
+			ramp = std::min(acceleration / jerk, accelerate / 2);
+			acceleration = jerk * ramp;
+		}
+		cruise = velocity > 0 ? (distance - velocity * accelerate) / velocity : 0;
+	}
+
+	// Where the rest-to-rest part is t s into its acceleration phase.
+	inline void speed_up(double t, double& position, double& speed, double& accel) {
+		if (t >= accelerate) {
+			position = velocity * accelerate / 2;
+			speed = velocity;
+			accel = 0;
+		} else if (t < ramp) {
+			accel = jerk * t;
+			speed = jerk * t * t / 2;
+			position = jerk * t * t * t / 6;
+		} else if (t <= accelerate - ramp) {
+			double into = t - ramp;
+			double begin = jerk * ramp * ramp / 2;
+			accel = acceleration;
+			speed = begin + acceleration * into;
+			position = jerk * ramp * ramp * ramp / 6 + begin * into + acceleration * into * into / 2;
+		} else {
+			// The end of the phase mirrors its start.
+			double left = accelerate - t;
+			accel = jerk * left;
+			speed = velocity - jerk * left * left / 2;
+			position = velocity * accelerate / 2 - (velocity * left - jerk * left * left * left / 6);
+		}
+	}
+
+	inline double rest_duration() {
+		return 2 * accelerate + cruise;
+	}
+
+	inline void rest_sample(double t, double& position, double& speed, double& accel) {
+		if (t >= rest_duration()) {
+			position = distance;
+			speed = 0;
+			accel = 0;
+		} else if (t <= accelerate) {
+			speed_up(t, position, speed, accel);
+		} else if (t <= accelerate + cruise) {
+			position = velocity * accelerate / 2 + velocity * (t - accelerate);
+			speed = velocity;
+			accel = 0;
+		} else {
+			speed_up(rest_duration() - t, position, speed, accel);
+			position = distance - position;
+			accel = -accel;
+		}
+		position *= sign;
+		speed *= sign;
+		accel *= sign;
+	}
+
+public:
+	struct Sample {
+		double position;
+		double velocity;
+		double acceleration;
+	};
+
+	Profile(double idistance, double imax_velocity, double imax_acceleration, double imax_jerk = 0, double istart_velocity = 0) :
+	max_velocity(imax_velocity), max_acceleration(imax_acceleration), velocity(imax_velocity), acceleration(imax_acceleration), jerk(imax_jerk) {
+		double toward = idistance < 0 ? -istart_velocity : istart_velocity;
+		double speed = std::min(toward, imax_velocity);
+		// Distance a rest-to-rest curve covers reaching the start speed, and
+		// by symmetry what it needs to stop from it.
+		double reach = speed > 0 ? speed * time_to(speed) / 2 : 0;
+		if (istart_velocity == 0 || (toward > 0 && reach <= std::abs(idistance))) {
+			plan(idistance);
+			// On an S-curve the speed passes the start speed still
+			// accelerating, so how far in that is depends on the plan and the
+			// plan on it; it settles in a couple of rounds.
+			for (int round = 0; speed > 0 && round < 5; round++) {
+				plan(idistance + sign * reach);
+				// The speed only rises through the acceleration phase.
+				double low = 0;
+				double high = accelerate;
+				for (int i = 0; i < 30; i++) {
+					double mid = (low + high) / 2;
+					double position, current, accel;
+					speed_up(mid, position, current, accel);
+					(current < speed ? low : high) = mid;
+				}
+				skip = (low + high) / 2;
+				double current, accel;
+				speed_up(skip, reach, current, accel);
+			}
+			skipped = sign * reach;
+		} else {
+			start = istart_velocity;
+			brake = std::abs(start) / imax_acceleration;
+			braked = start * brake / 2;
+			plan(idistance - braked);
+		}
+	}
+
+	inline double duration() {
+		return brake + rest_duration() - skip;
+	}
+
+	inline Sample sample(double t) {
+		Sample out;
+		t = std::max(t, 0.0);
+		if (t < brake) {
+			double slow = -start / brake;
+			out.position = start * t + slow * t * t / 2;
+			out.velocity = start + slow * t;
+			out.acceleration = slow;
+			return out;
+		}
+		rest_sample(t - brake + skip, out.position, out.velocity, out.acceleration);
+		out.position += braked - skipped;
+		return out;
+	}
+};
+
 struct Position {
     double x;
     double y;
@@ -131,27 +508,851 @@ struct Position {
     double heading;
 };
 
+// A point on a path, in cm in Odom's frame.
+struct Waypoint {
+    double x;
+    double y;
+};
+
+// One point of a trajectory precompiled by hbot_trajectories, in fixed point
+// to keep the tables small: position in 1/16 cm, yaw in 1/8192 rad, velocity
+// in 1/64 cm/s, acceleration in 1/8 cm/s^2 and curvature in 1/65536 per cm.
+struct TrajectoryPoint {
+	static constexpr double POSITION = 16;
+	static constexpr double YAW = 8192;
+	static constexpr double VELOCITY = 64;
+	static constexpr double ACCELERATION = 8;
+	static constexpr double CURVATURE = 65536;
+
+	int16_t x;
+	int16_t y;
+	int16_t yaw;
+	int16_t velocity;
+	int16_t acceleration;
+	int16_t curvature;
+};
+
+// A precompiled trajectory, one point every step seconds.
+struct Trajectory {
+	const TrajectoryPoint* points;
+	std::size_t size;
+	double step;
+	bool reverse;
+};
+
+// Complementary filter between an IMU's yaw and the tracking wheels' heading.
+// The gyro carries the short term, so wheel slip in a bump never reaches the
+// heading, and the wheels pull the long term back and learn the gyro's bias
+// whenever the robot sits still. A step where the two disagree by more than
+// SLIP_RATE counts as slip and follows the gyro alone. If the IMU stops
+// answering, the wheels cover for it until it is back. If it disagrees for
+// DIVERGE_TIME straight or its bias runs past MAX_BIAS it is dropped for good,
+// and the disagreeing stretch is replayed from the wheels.
+class HeadingFilter {
+	pros::Imu imu;
+	const double time_constant;
+
+	double prev_rotation = NAN;
+	double reference = 0;
+	double theta = 0;
+	double bias = 0;
+
+	double disagreeing = 0;
+	double checkpoint = 0;
+	double wheel_since = 0;
+
+	bool diverged = false;
+	std::atomic<bool> fusing{false};
+
+public:
+	static constexpr double SLIP_RATE = 10 * DEGREE_TO_RADIAN;   // rad/s
+	static constexpr double STILL_RATE = 1 * DEGREE_TO_RADIAN;   // rad/s
+	static constexpr double MAX_BIAS = 2 * DEGREE_TO_RADIAN;     // rad/s
+	static constexpr double DIVERGE_TIME = 1.0;                  // s
+	static constexpr double BIAS_TIME = 5.0;                     // s
+
+	HeadingFilter(pros::Imu iimu, double itime_constant = 0.5) : imu(iimu), time_constant(itime_constant) {
+		imu.reset();
+	}
+
+	// Takes the wheels' heading change over the last dt seconds and returns
+	// the fused change, both in radians clockwise.
+	inline double step(double wheel_delta, double dt) {
+		double rotation = imu.get_rotation();
+		bool valid = std::isfinite(rotation) && std::isfinite(prev_rotation);
+		double gyro_delta = valid ? (rotation - prev_rotation) * DEGREE_TO_RADIAN - bias * dt : 0;
+		prev_rotation = rotation;
+		double previous = theta;
+
+		if (diverged || !valid) {
+			fusing.store(false, std::memory_order_relaxed);
+			reference += wheel_delta;
+			theta += wheel_delta;
+			disagreeing = 0;
+			return wheel_delta;
+		}
+
+		double residual = gyro_delta - wheel_delta;
+		if (std::abs(residual) > SLIP_RATE * dt) {
+			if (disagreeing == 0) {
+				checkpoint = theta;
+				wheel_since = 0;
+			}
+			disagreeing += dt;
+			wheel_since += wheel_delta;
+			reference += gyro_delta;
+		} else {
+			disagreeing = 0;
+			reference += wheel_delta;
+			if (std::abs(wheel_delta) < STILL_RATE * dt) {
+				bias += residual / BIAS_TIME;
+			}
+		}
+
+		if (disagreeing > DIVERGE_TIME || std::abs(bias) > MAX_BIAS) {
+			LOG("[Odom] IMU diverged, using tracking wheels only\n");
+			diverged = true;
+			if (disagreeing > DIVERGE_TIME) {
+				theta = checkpoint + wheel_since;
+			} else {
+				theta += wheel_delta;
+			}
+			reference = theta;
+			fusing.store(false, std::memory_order_relaxed);
+			return theta - previous;
+		}
+
+		double alpha = time_constant / (time_constant + dt);
+		theta = alpha * (theta + gyro_delta) + (1 - alpha) * reference;
+		fusing.store(true, std::memory_order_relaxed);
+		return theta - previous;
+	}
+
+	// Whether the last step used the IMU.
+	inline bool fused() {
+		return fusing.load(std::memory_order_relaxed);
+	}
+
+	inline void set_data_rate(unsigned long rate) {
+		imu.set_data_rate(rate);
+	}
+};
+
+// Walls and obstacles of the field as line segments, in cm from the field
+// centre in the frame pros::Gps reports in: +y is heading 0 and headings turn
+// clockwise.
+struct FieldMap {
+	struct Segment {
+		double x1;
+		double y1;
+		double x2;
+		double y2;
+	};
+
+	struct Hit {
+		double distance;  // cm, INFINITY when the ray hits nothing
+		double nx;        // unit normal of the segment hit, facing back at the ray
+		double ny;
+	};
+
+	std::vector<Segment> segments;
+
+	// Casts a ray from (x, y) along heading, in radians.
+	inline Hit raycast(double x, double y, double heading) const {
+		double dx = std::sin(heading);
+		double dy = std::cos(heading);
+		Hit hit{INFINITY, 0, 0};
+
+		for (auto& segment : segments) {
+			double ex = segment.x2 - segment.x1;
+			double ey = segment.y2 - segment.y1;
+			double denom = dx * ey - dy * ex;
+			if (std::abs(denom) < 1e-12) {
+				continue;
+			}
+
+			double wx = segment.x1 - x;
+			double wy = segment.y1 - y;
+			double t = (wx * ey - wy * ex) / denom;
+			double u = (wx * dy - wy * dx) / denom;
+			if (t <= 0 || u < 0 || u > 1 || t >= hit.distance) {
+				continue;
+			}
+
+			double length = std::hypot(ex, ey);
+			double nx = -ey / length;
+			double ny = ex / length;
+			if (nx * dx + ny * dy > 0) {
+				nx = -nx;
+				ny = -ny;
+			}
+			hit = {t, nx, ny};
+		}
+		return hit;
+	}
+
+	// Adds the outline of an obstacle, corners in order around it.
+	inline FieldMap& add_polygon(const std::vector<std::pair<double, double>>& corners) {
+		for (std::size_t i = 0; i < corners.size(); i++) {
+			auto& from = corners[i];
+			auto& to = corners[(i + 1) % corners.size()];
+			segments.push_back({from.first, from.second, to.first, to.second});
+		}
+		return *this;
+	}
+
+	// The perimeter walls of a square field, size cm across.
+	inline static FieldMap walls(double size = 144 * INCH_TO_CM) {
+		double half = size / 2;
+		return FieldMap{{
+			{-half, -half, half, -half},
+			{half, -half, half, half},
+			{half, half, -half, half},
+			{-half, half, -half, -half},
+		}};
+	}
+};
+
+// Reads a distance sensor in cm along with its rated deviation, 15 mm under
+// 200 mm and 5% beyond. Returns false when nothing is in range or the sensor
+// is not confident in what it sees.
+inline bool read_distance(pros::Distance& sensor, double& range, double& deviation) {
+	std::int32_t raw = sensor.get();
+	if (raw == PROS_ERR || raw <= 0 || raw >= 2000) {
+		return false;
+	}
+	// Confidence runs 0-63 and is only reported past 200 mm.
+	if (raw > 200 && sensor.get_confidence() < 32) {
+		return false;
+	}
+	range = raw / 10.0;
+	deviation = range < 20 ? 1.5 : range * 0.05;
+	return true;
+}
+
+// Monte Carlo localization of the field pose from Odom's motion and
+// pros::Distance rays against a FieldMap. Particles live in fixed arrays, one
+// per coordinate, so every per-particle pass runs over contiguous floats the
+// compiler can vectorise for NEON, and nothing allocates after construction.
+// Motion is gathered every Odom cycle and spread over the particles with
+// noise at each update; each reading then weights them by a Gaussian around
+// their own ray cast, with a floor for readings cut short by robots and game
+// objects, and low-variance resampling runs once the effective count drops
+// under half.
+class ParticleFilter {
+public:
+	static constexpr std::size_t MAX_PARTICLES = 2048;
+	static constexpr float FORWARD_NOISE = 0.05f;   // share of the distance driven
+	static constexpr float TURN_NOISE = 0.05f;      // share of the angle turned
+	static constexpr float SLIDE_NOISE = 0.5f;      // cm per update, for pushes Odom cannot see
+	static constexpr float SHORT_FLOOR = 0.05f;     // likelihood of a reading no ray explains
+
+private:
+	struct Beam {
+		pros::Distance sensor;
+		float forward;    // cm ahead of the tracking centre
+		float right;      // cm right of it
+		float angle;      // radians clockwise from straight ahead
+	};
+
+	FieldMap map;
+	const std::size_t count;
+	std::vector<Beam> beams;
+	uint32_t seed;
+
+	// Motion since the last update, in the robot's frame at that update.
+	float moved_forward = 0;
+	float moved_right = 0;
+	float moved_turn = 0;
+
+	alignas(16) float xs[MAX_PARTICLES];
+	alignas(16) float ys[MAX_PARTICLES];
+	alignas(16) float headings[MAX_PARTICLES];
+	alignas(16) float weights[MAX_PARTICLES];
+
+	// Scratch for ray casting and resampling.
+	alignas(16) float origin_x[MAX_PARTICLES];
+	alignas(16) float origin_y[MAX_PARTICLES];
+	alignas(16) float ray_x[MAX_PARTICLES];
+	alignas(16) float ray_y[MAX_PARTICLES];
+	alignas(16) float ranges[MAX_PARTICLES];
+	alignas(16) float sines[MAX_PARTICLES];
+	alignas(16) float cosines[MAX_PARTICLES];
+	alignas(16) float spare[3][MAX_PARTICLES];
+
+	inline float uniform() {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		return (seed >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// Roughly normal with unit deviation, from four uniforms.
+	inline float noise() {
+		return (uniform() + uniform() + uniform() + uniform() - 2.0f) * 1.7320508f;
+	}
+
+	// Needs sines and cosines of the headings filled in.
+	inline void cast(const Beam& beam) {
+		float beam_s = std::sin(beam.angle);
+		float beam_c = std::cos(beam.angle);
+		for (std::size_t i = 0; i < count; i++) {
+			float s = sines[i];
+			float c = cosines[i];
+			origin_x[i] = xs[i] + beam.forward * s + beam.right * c;
+			origin_y[i] = ys[i] + beam.forward * c - beam.right * s;
+			ray_x[i] = s * beam_c + c * beam_s;
+			ray_y[i] = c * beam_c - s * beam_s;
+			ranges[i] = INFINITY;
+		}
+
+		// Segments outside, particles inside and no branches, so the inner loop
+		// vectorises. A parallel ray divides by zero and fails every compare.
+		for (auto& segment : map.segments) {
+			float x1 = segment.x1;
+			float y1 = segment.y1;
+			float ex = segment.x2 - segment.x1;
+			float ey = segment.y2 - segment.y1;
+			for (std::size_t i = 0; i < count; i++) {
+				float denom = ray_x[i] * ey - ray_y[i] * ex;
+				float wx = x1 - origin_x[i];
+				float wy = y1 - origin_y[i];
+				float t = (wx * ey - wy * ex) / denom;
+				float u = (wx * ray_y[i] - wy * ray_x[i]) / denom;
+				bool hit = t > 0 && u >= 0 && u <= 1 && t < ranges[i];
+				ranges[i] = hit ? t : ranges[i];
+			}
+		}
+	}
+
+	inline void resample() {
+		float step = 1.0f / count;
+		float target = uniform() * step;
+		float total = weights[0];
+		std::size_t j = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			while (target > total && j + 1 < count) {
+				total += weights[++j];
+			}
+			spare[0][i] = xs[j];
+			spare[1][i] = ys[j];
+			spare[2][i] = headings[j];
+			target += step;
+		}
+		std::copy(spare[0], spare[0] + count, xs);
+		std::copy(spare[1], spare[1] + count, ys);
+		std::copy(spare[2], spare[2] + count, headings);
+		std::fill(weights, weights + count, step);
+		for (std::size_t i = 0; i < count; i++) {
+			sines[i] = std::sin(headings[i]);
+			cosines[i] = std::cos(headings[i]);
+		}
+	}
+
+public:
+	// icount particles around (ix, iy) cm facing iheading degrees, in the
+	// pros::Gps frame, spread by the given deviations.
+	ParticleFilter(FieldMap imap, std::size_t icount, double ix, double iy, double iheading,
+	double ispread = 2, double iheading_spread = 1, uint32_t iseed = 1) :
+	map(std::move(imap)), count(std::clamp<std::size_t>(icount, 1, MAX_PARTICLES)), seed(iseed | 1) {
+		for (std::size_t i = 0; i < count; i++) {
+			xs[i] = ix + noise() * ispread;
+			ys[i] = iy + noise() * ispread;
+			headings[i] = (iheading + noise() * iheading_spread) * DEGREE_TO_RADIAN;
+			sines[i] = std::sin(headings[i]);
+			cosines[i] = std::cos(headings[i]);
+			weights[i] = 1.0f / count;
+		}
+	}
+
+	// A distance sensor iforward cm ahead and iright cm right of the tracking
+	// centre, pointing iangle degrees clockwise from straight ahead.
+	inline void add_distance(pros::Distance isensor, double iforward, double iright, double iangle) {
+		beams.push_back({isensor, static_cast<float>(iforward), static_cast<float>(iright),
+		                 static_cast<float>(iangle * DEGREE_TO_RADIAN)});
+	}
+
+	// Gathers one Odom step, in cm and radians in the robot's frame.
+	inline void move(double forward, double right, double turn) {
+		float s = std::sin(moved_turn);
+		float c = std::cos(moved_turn);
+		moved_forward += forward * c - right * s;
+		moved_right += forward * s + right * c;
+		moved_turn += turn;
+	}
+
+	// Applies the gathered motion and weighs the particles on fresh readings.
+	inline void update() {
+		float forward_spread = FORWARD_NOISE * std::abs(moved_forward) + SLIDE_NOISE;
+		float right_spread = FORWARD_NOISE * std::abs(moved_right) + SLIDE_NOISE;
+		float turn_spread = TURN_NOISE * std::abs(moved_turn) + 0.2f * DEGREE_TO_RADIAN;
+		for (std::size_t i = 0; i < count; i++) {
+			float forward = moved_forward + noise() * forward_spread;
+			float right = moved_right + noise() * right_spread;
+			float s = sines[i];
+			float c = cosines[i];
+			xs[i] += forward * s + right * c;
+			ys[i] += forward * c - right * s;
+			headings[i] += moved_turn + noise() * turn_spread;
+			sines[i] = std::sin(headings[i]);
+			cosines[i] = std::cos(headings[i]);
+		}
+		moved_forward = moved_right = moved_turn = 0;
+
+		bool weighed = false;
+		for (auto& beam : beams) {
+			double range, deviation;
+			if (!read_distance(beam.sensor, range, deviation)) {
+				continue;
+			}
+			float measured = range;
+			float scale = -0.5f / (deviation * deviation);
+
+			cast(beam);
+			for (std::size_t i = 0; i < count; i++) {
+				float error = measured - ranges[i];
+				weights[i] *= std::exp(scale * error * error) + SHORT_FLOOR;
+			}
+			weighed = true;
+		}
+		if (!weighed) {
+			return;
+		}
+
+		float total = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			total += weights[i];
+		}
+		float squares = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			weights[i] /= total;
+			squares += weights[i] * weights[i];
+		}
+		if (1.0f / squares < count / 2.0f) {
+			resample();
+		}
+	}
+
+	// Weighted mean pose in cm and radians, and its variance per component.
+	inline void estimate(double (&pose)[3], double (&variance)[3]) {
+		double mean_x = 0;
+		double mean_y = 0;
+		double mean_s = 0;
+		double mean_c = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			mean_x += weights[i] * xs[i];
+			mean_y += weights[i] * ys[i];
+			mean_s += weights[i] * std::sin(headings[i]);
+			mean_c += weights[i] * std::cos(headings[i]);
+		}
+		double mean_heading = std::atan2(mean_s, mean_c);
+
+		variance[0] = variance[1] = variance[2] = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			variance[0] += weights[i] * (xs[i] - mean_x) * (xs[i] - mean_x);
+			variance[1] += weights[i] * (ys[i] - mean_y) * (ys[i] - mean_y);
+			double turn = std::remainder(headings[i] - mean_heading, 2 * M_PI);
+			variance[2] += weights[i] * turn * turn;
+		}
+		pose[0] = mean_x;
+		pose[1] = mean_y;
+		pose[2] = mean_heading;
+	}
+
+	inline std::size_t size() {
+		return count;
+	}
+
+	inline static std::unique_ptr<ParticleFilter> create(FieldMap imap, std::size_t icount, double ix, double iy, double iheading) {
+		return std::make_unique<ParticleFilter>(std::move(imap), icount, ix, iy, iheading);
+	}
+};
+
+// Pulls Odom's pose back onto the field from absolute sensors, so slip and
+// pushes stop compounding over a long run. A Kalman filter over the field pose
+// takes pros::Gps fixes weighted by the error the sensor reports, and
+// pros::Distance readings against a FieldMap weighted by the sensor's rated
+// accuracy, or whole pose fixes from a ParticleFilter weighted by the spread
+// of its cloud. A reading more than GATE standard deviations out is dropped
+// as an outlier, unless REJECT_LIMIT in a row from one sensor disagree, which
+// means Odom itself has jumped and the filter opens up to take them.
+// Corrections are bled into the pose over SMOOTH_TIME, no faster than
+// MAX_SHIFT and MAX_TURN, so a controller mid-motion never sees a step.
+class Localizer {
+	struct Mount {
+		pros::Distance sensor;
+		double forward;   // cm ahead of the tracking centre
+		double right;     // cm right of it
+		double angle;     // radians clockwise from straight ahead
+		int rejected;
+	};
+
+	FieldMap map;
+	const double start_x;
+	const double start_y;
+	const double start_heading;
+
+	std::unique_ptr<pros::Gps> gps;
+	int gps_rejected = 0;
+	std::vector<Mount> mounts;
+	std::unique_ptr<ParticleFilter> particles;
+	int particles_rejected = 0;
+
+	// Field pose covariance, x and y in cm and heading in radians.
+	double cov[3][3] = {};
+	// Correction still to be bled into the pose, in the field frame.
+	double pending[3] = {};
+
+	double prev_x = 0;
+	double prev_y = 0;
+	double prev_theta = 0;
+	double since_update = 0;
+
+	std::atomic<uint32_t> accepted_count{0};
+	std::atomic<uint32_t> rejected_count{0};
+	std::atomic<double> position_sd{0};
+
+	// Field pose of an Odom pose, with the pending correction.
+	inline void field_pose(double x, double y, double theta, double (&field)[3]) {
+		double s = std::sin(start_heading);
+		double c = std::cos(start_heading);
+		field[0] = start_x + x * s + y * c + pending[0];
+		field[1] = start_y + x * c - y * s + pending[1];
+		field[2] = start_heading + theta + pending[2];
+	}
+
+	inline void predict(double forward, double turn, double heading) {
+		// Moving forward along the heading carries heading error into position.
+		double jacobian[2] = {forward * std::cos(heading), -forward * std::sin(heading)};
+		for (int i = 0; i < 2; i++) {
+			for (int j = 0; j < 3; j++) {
+				cov[i][j] += jacobian[i] * cov[2][j];
+			}
+		}
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 2; j++) {
+				cov[i][j] += cov[i][2] * jacobian[j];
+			}
+		}
+
+		cov[0][0] += POSITION_DRIFT * std::abs(forward);
+		cov[1][1] += POSITION_DRIFT * std::abs(forward);
+		cov[2][2] += HEADING_DRIFT * std::abs(turn);
+	}
+
+	// Folds in one scalar reading with the given residual, state Jacobian and
+	// variance. Returns whether it was used.
+	inline bool update(double residual, const double (&jacobian)[3], double variance, int& rejected) {
+		double gain[3];
+		double innovation = variance;
+		auto project = [&] {
+			innovation = variance;
+			for (int i = 0; i < 3; i++) {
+				gain[i] = cov[i][0] * jacobian[0] + cov[i][1] * jacobian[1] + cov[i][2] * jacobian[2];
+				innovation += jacobian[i] * gain[i];
+			}
+		};
+		project();
+
+		if (residual * residual > GATE * GATE * innovation) {
+			rejected_count.fetch_add(1, std::memory_order_relaxed);
+			if (++rejected < REJECT_LIMIT) {
+				return false;
+			}
+			// The sensor has disagreed for a while: trust it over the pose.
+			cov[0][0] += residual * residual;
+			cov[1][1] += residual * residual;
+			project();
+		}
+		rejected = 0;
+
+		double row[3];
+		for (int j = 0; j < 3; j++) {
+			row[j] = jacobian[0] * cov[0][j] + jacobian[1] * cov[1][j] + jacobian[2] * cov[2][j];
+		}
+		for (int i = 0; i < 3; i++) {
+			gain[i] /= innovation;
+			pending[i] += gain[i] * residual;
+			for (int j = 0; j < 3; j++) {
+				cov[i][j] -= gain[i] * row[j];
+			}
+		}
+		accepted_count.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// Folds in a whole pose fix. A fix is all or nothing: one component out
+	// of the gate drops it.
+	inline void update_fix(const double (&measured)[3], const double (&variances)[3], int& rejected,
+	                       const double (&field)[3]) {
+		double residual[3] = {
+			measured[0] - field[0],
+			measured[1] - field[1],
+			std::remainder(measured[2] - field[2], 2 * M_PI),
+		};
+
+		bool outlier = false;
+		for (int i = 0; i < 3; i++) {
+			outlier |= residual[i] * residual[i] > GATE * GATE * (cov[i][i] + variances[i]);
+		}
+		if (outlier && rejected + 1 < REJECT_LIMIT) {
+			rejected++;
+			rejected_count.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		if (outlier) {
+			for (int i = 0; i < 3; i++) {
+				cov[i][i] += residual[i] * residual[i];
+			}
+		}
+		rejected = 0;
+
+		// Each component goes in on its own, against the estimate the ones
+		// before it left behind.
+		double before[3] = {pending[0], pending[1], pending[2]};
+		for (int i = 0; i < 3; i++) {
+			double jacobian[3] = {};
+			jacobian[i] = 1;
+			update(residual[i] - (pending[i] - before[i]), jacobian, variances[i], rejected);
+		}
+	}
+
+	inline void update_gps(const double (&field)[3]) {
+		double error = gps->get_error();
+		auto status = gps->get_status();
+		double heading = gps->get_heading();
+		if (!std::isfinite(error) || !std::isfinite(status.x) || !std::isfinite(status.y) || !std::isfinite(heading)) {
+			return;
+		}
+
+		double variance = std::pow(std::max(error * 100, GPS_MIN_ERROR), 2);
+		double measured[3] = {status.x * 100, status.y * 100, heading * DEGREE_TO_RADIAN};
+		double variances[3] = {variance, variance, GPS_HEADING_ERROR * GPS_HEADING_ERROR};
+		update_fix(measured, variances, gps_rejected, field);
+	}
+
+	// The particle cloud's spread is its variance, but never below a floor,
+	// since the same readings keep feeding it.
+	inline void update_particles(const double (&field)[3]) {
+		particles->update();
+		double measured[3];
+		double variances[3];
+		particles->estimate(measured, variances);
+		variances[0] = std::max(variances[0], PARTICLE_MIN_VARIANCE);
+		variances[1] = std::max(variances[1], PARTICLE_MIN_VARIANCE);
+		variances[2] = std::max(variances[2], GPS_HEADING_ERROR * GPS_HEADING_ERROR);
+		update_fix(measured, variances, particles_rejected, field);
+	}
+
+	inline void update_distance(Mount& mount, const double (&field)[3]) {
+		double measured, error;
+		if (!read_distance(mount.sensor, measured, error)) {
+			return;
+		}
+
+		double s = std::sin(field[2]);
+		double c = std::cos(field[2]);
+		double x = field[0] + mount.forward * s + mount.right * c;
+		double y = field[1] + mount.forward * c - mount.right * s;
+		double ray = field[2] + mount.angle;
+		auto hit = map.raycast(x, y, ray);
+
+		// Glancing hits scatter off the wall and are not worth the risk.
+		double incidence = hit.nx * std::sin(ray) + hit.ny * std::cos(ray);
+		if (!std::isfinite(hit.distance) || hit.distance > 200 || incidence > -0.5) {
+			return;
+		}
+
+		double swing_x = mount.forward * c - mount.right * s;
+		double swing_y = -mount.forward * s - mount.right * c;
+		double sweep = hit.nx * std::cos(ray) - hit.ny * std::sin(ray);
+		double jacobian[3] = {
+			-hit.nx / incidence,
+			-hit.ny / incidence,
+			-(hit.nx * swing_x + hit.ny * swing_y + hit.distance * sweep) / incidence,
+		};
+		update(measured - hit.distance, jacobian, error * error, mount.rejected);
+	}
+
+public:
+	static constexpr double GATE = 3;                             // standard deviations
+	static constexpr int REJECT_LIMIT = 5;                        // readings in a row
+	static constexpr double UPDATE_INTERVAL = 0.05;               // s between readings
+	static constexpr double SMOOTH_TIME = 0.3;                    // s
+	static constexpr double MAX_SHIFT = 30;                       // cm/s
+	static constexpr double MAX_TURN = 15 * DEGREE_TO_RADIAN;     // rad/s
+	static constexpr double POSITION_DRIFT = 0.02;                // cm^2 per cm driven
+	static constexpr double HEADING_DRIFT = 4e-4;                 // rad^2 per rad turned
+	static constexpr double GPS_MIN_ERROR = 0.5;                  // cm
+	static constexpr double GPS_HEADING_ERROR = 2 * DEGREE_TO_RADIAN;
+	static constexpr double PARTICLE_MIN_VARIANCE = 4;            // cm^2
+
+	// Odom's origin sits at (ix, iy) cm on the field facing iheading degrees,
+	// all in the pros::Gps frame.
+	Localizer(FieldMap imap, double ix, double iy, double iheading) :
+	map(std::move(imap)), start_x(ix), start_y(iy), start_heading(iheading * DEGREE_TO_RADIAN) {
+		cov[0][0] = cov[1][1] = 4;
+		cov[2][2] = std::pow(1 * DEGREE_TO_RADIAN, 2);
+		position_sd.store(2, std::memory_order_relaxed);
+	}
+
+	// The GPS should have its offset to the tracking centre set.
+	inline void add_gps(pros::Gps igps) {
+		gps = std::make_unique<pros::Gps>(igps);
+	}
+
+	// A distance sensor iforward cm ahead and iright cm right of the tracking
+	// centre, pointing iangle degrees clockwise from straight ahead.
+	inline void add_distance(pros::Distance isensor, double iforward, double iright, double iangle) {
+		mounts.push_back({isensor, iforward, iright, iangle * DEGREE_TO_RADIAN, 0});
+	}
+
+	// Takes fixes from a particle filter, which should own the distance
+	// sensors rather than this.
+	inline void add_particles(std::unique_ptr<ParticleFilter> iparticles) {
+		particles = std::move(iparticles);
+	}
+
+	// Runs once per Odom cycle on Odom's own pose, in its frame.
+	inline void step(double& x, double& y, double& theta, double dt) {
+		// Signed, so reversing carries heading error into position the
+		// other way.
+		double along = std::cos(prev_theta);
+		double across = std::sin(prev_theta);
+		double forward = (x - prev_x) * along + (y - prev_y) * across;
+		double turn = theta - prev_theta;
+		if (particles) {
+			particles->move(forward, (y - prev_y) * along - (x - prev_x) * across, turn);
+		}
+		double field[3];
+		field_pose(x, y, theta, field);
+		predict(forward, turn, field[2]);
+
+		since_update += dt;
+		if (since_update >= UPDATE_INTERVAL) {
+			since_update = 0;
+			if (gps) {
+				field_pose(x, y, theta, field);
+				update_gps(field);
+			}
+			for (auto& mount : mounts) {
+				field_pose(x, y, theta, field);
+				update_distance(mount, field);
+			}
+			if (particles) {
+				field_pose(x, y, theta, field);
+				update_particles(field);
+			}
+		}
+
+		double share = std::min(1.0, dt / SMOOTH_TIME);
+		double shift[3] = {pending[0] * share, pending[1] * share, pending[2] * share};
+		double length = std::hypot(shift[0], shift[1]);
+		if (length > MAX_SHIFT * dt) {
+			shift[0] *= MAX_SHIFT * dt / length;
+			shift[1] *= MAX_SHIFT * dt / length;
+		}
+		shift[2] = std::clamp(shift[2], -MAX_TURN * dt, MAX_TURN * dt);
+
+		double s = std::sin(start_heading);
+		double c = std::cos(start_heading);
+		x += shift[0] * s + shift[1] * c;
+		y += shift[0] * c - shift[1] * s;
+		theta += shift[2];
+		for (int i = 0; i < 3; i++) {
+			pending[i] -= shift[i];
+		}
+
+		prev_x = x;
+		prev_y = y;
+		prev_theta = theta;
+		position_sd.store(std::sqrt(std::max(cov[0][0], cov[1][1])), std::memory_order_relaxed);
+	}
+
+	inline uint32_t accepted() {
+		return accepted_count.load(std::memory_order_relaxed);
+	}
+
+	inline uint32_t rejected() {
+		return rejected_count.load(std::memory_order_relaxed);
+	}
+
+	// Standard deviation of the position estimate along its worse axis, cm.
+	inline double uncertainty() {
+		return position_sd.load(std::memory_order_relaxed);
+	}
+
+	inline static std::unique_ptr<Localizer> create(FieldMap imap, double ix, double iy, double iheading) {
+		return std::make_unique<Localizer>(std::move(imap), ix, iy, iheading);
+	}
+};
+
 class Odom {
 	pros::Rotation left;
 	pros::Rotation right;
-
-	pros::Mutex lock;
-    pros::Task thread;
+	std::unique_ptr<pros::Rotation> back;
 
 	const double diameter;
 	const double trackwidth;
+	const double back_offset;
+	const unsigned long interval;
+	std::unique_ptr<HeadingFilter> filter;
+
+	struct Pose {
+		double x;
+		double y;
+		double theta;
+	};
 
-    double prev_l = 0;
-    double prev_r = 0;
+	// Double buffered seqlock. The count is odd while the loop fills the slot
+	// readers are not using and count / 2 picks the last complete slot, so
+	// readers never wait on the loop and retry only if the loop started
+	// overwriting their slot while they were copying it.
+	std::atomic<uint32_t> sequence{0};
+	Pose slots[2] = {};
+
+	// How late each wake-up landed after its delay_until deadline, in
+	// microseconds.
+	std::atomic<uint32_t> jitter_total{0};
+	std::atomic<uint32_t> jitter_max{0};
+	std::atomic<uint32_t> cycles{0};
+
+	// A Localizer handed over by localize() waits in incoming until the loop
+	// takes it; from then on only the loop touches it.
+	std::atomic<Localizer*> incoming{nullptr};
+	std::atomic<Localizer*> active{nullptr};
+	std::unique_ptr<Localizer> localizer;
 
-    double global_x = 0;
-    double global_y = 0;
-    double global_theta = 0;
+    pros::Task thread;
+
+	inline void publish(const Pose& pose) {
+		uint32_t start = sequence.load(std::memory_order_relaxed);
+		sequence.store(start + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slots[((start >> 1) + 1) & 1] = pose;
+		sequence.store(start + 2, std::memory_order_release);
+	}
+
+	inline Pose snapshot() {
+		while (true) {
+			uint32_t current = sequence.load(std::memory_order_acquire);
+			Pose pose = slots[(current >> 1) & 1];
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (sequence.load(std::memory_order_relaxed) - (current & ~1u) < 3) {
+				return pose;
+			}
+		}
+	}
 
     void loop() {
+        double prev_l = 0;
+        double prev_r = 0;
+        double prev_b = 0;
+        Pose pose{0, 0, 0};
+
+        uint32_t wake = pros::millis();
+
         while (true) {
-            std::unique_lock<pros::Mutex> guard(lock);
-            
             double current_l = left.get_position() / 36000.0 * diameter * M_PI;
             double current_r = right.get_position() / 36000.0 * diameter * M_PI;
             
@@ -162,31 +1363,101 @@ class Odom {
             double local_x = (delta_l + delta_r) / 2.0;
             double local_y = 0;
 
-            global_theta = global_theta + local_theta;
+            if (filter) {
+                local_theta = filter->step(local_theta, interval / 1000.0);
+            }
+
+            // The back wheel sees sideways motion plus its swing about the
+            // centre while turning, which is taken back out.
+            if (back) {
+                double current_b = back->get_position() / 36000.0 * diameter * M_PI;
+                local_y = (current_b - prev_b) + back_offset * local_theta;
+                prev_b = current_b;
+            }
+
+            // Treat the step as an arc: move along its chord, which points at
+            // the heading halfway through the turn.
+            double chord = 1;
+            if (std::abs(local_theta) > 1e-9) {
+                chord = 2.0 * std::sin(local_theta / 2.0) / local_theta;
+            }
+            double mid_theta = pose.theta + local_theta / 2.0;
+            double sin_theta = std::sin(mid_theta);
+            double cos_theta = std::cos(mid_theta);
 
-            double sin_theta = std::sin(global_theta);
-            double cos_theta = std::cos(global_theta);
+            pose.x += chord * (local_x * cos_theta - local_y * sin_theta);
+            pose.y += chord * (local_y * cos_theta + local_x * sin_theta);
+            pose.theta += local_theta;
 
-            global_x += (local_x * cos_theta - local_y * sin_theta);
-            global_y += (local_y * cos_theta + local_x * sin_theta);
+            if (Localizer* next = incoming.exchange(nullptr, std::memory_order_acquire)) {
+                localizer.reset(next);
+                active.store(next, std::memory_order_release);
+            }
+            if (localizer) {
+                localizer->step(pose.x, pose.y, pose.theta, interval / 1000.0);
+            }
 
             prev_l = current_l;
             prev_r = current_r;
 
-            guard.unlock();
-            pros::delay(20);
+            publish(pose);
+            pros::Task::delay_until(&wake, interval);
+
+            // delay_until has moved wake on to the deadline it just slept
+            // to, so this is how late the loop woke against its schedule.
+            int64_t late = static_cast<int64_t>(pros::micros()) - static_cast<int64_t>(wake) * 1000;
+            uint32_t jitter = static_cast<uint32_t>(std::max<int64_t>(late, 0));
+
+            jitter_total.fetch_add(jitter, std::memory_order_relaxed);
+            cycles.fetch_add(1, std::memory_order_relaxed);
+            if (jitter > jitter_max.load(std::memory_order_relaxed)) {
+                jitter_max.store(jitter, std::memory_order_relaxed);
+            }
         }
     }
 public:
-	Odom(pros::Rotation ileft, pros::Rotation iright, double idiameter, double itrackwidth) : 
-    left(ileft), right(iright), diameter(idiameter), trackwidth(itrackwidth), thread([&]{ this->loop(); }) {
+	Odom(pros::Rotation ileft, pros::Rotation iright, std::unique_ptr<pros::Rotation> iback, std::unique_ptr<HeadingFilter> ifilter,
+	double idiameter, double itrackwidth, double iback_offset, unsigned long iinterval) :
+    left(ileft), right(iright), back(std::move(iback)), diameter(idiameter), trackwidth(itrackwidth), back_offset(iback_offset),
+	interval(iinterval), filter(std::move(ifilter)), thread([&]{ this->loop(); }) {
+		unsigned long rate = std::max(interval, 5ul);
 		left.set_position(0);
 		right.set_position(0);
+		left.set_data_rate(rate);
+		right.set_data_rate(rate);
+		if (back) {
+			back->set_position(0);
+			back->set_data_rate(rate);
+		}
+		if (filter) {
+			filter->set_data_rate(rate);
+		}
+	}
+
+	Odom(pros::Rotation ileft, pros::Rotation iright, double idiameter, double itrackwidth, unsigned long iinterval = 20) : 
+    Odom(ileft, iright, nullptr, nullptr, idiameter, itrackwidth, 0, iinterval) {
+	}
+
+	Odom(pros::Rotation ileft, pros::Rotation iright, pros::Imu iimu, double idiameter, double itrackwidth, unsigned long iinterval = 20) : 
+    Odom(ileft, iright, nullptr, std::make_unique<HeadingFilter>(iimu), idiameter, itrackwidth, 0, iinterval) {
+	}
+
+	// With a third wheel perpendicular to the others, iback_offset cm behind
+	// the tracking centre and reading positive as the robot slides right.
+	Odom(pros::Rotation ileft, pros::Rotation iright, pros::Rotation iback, double idiameter, double itrackwidth, double iback_offset, unsigned long iinterval = 20) : 
+    Odom(ileft, iright, std::make_unique<pros::Rotation>(iback), nullptr, idiameter, itrackwidth, iback_offset, iinterval) {
+	}
+
+	Odom(pros::Rotation ileft, pros::Rotation iright, pros::Rotation iback, pros::Imu iimu, double idiameter, double itrackwidth, double iback_offset, unsigned long iinterval = 20) : 
+    Odom(ileft, iright, std::make_unique<pros::Rotation>(iback), std::make_unique<HeadingFilter>(iimu), idiameter, itrackwidth, iback_offset, iinterval) {
+	}
+
+	~Odom() {
+		delete incoming.exchange(nullptr);
 	}
 	
 	inline double heading(bool radians = false) {
-		std::lock_guard<pros::Mutex> guard(lock);
-		double wrapped = std::fmod(global_theta, 360 * DEGREE_TO_RADIAN);
+		double wrapped = std::fmod(snapshot().theta, 360 * DEGREE_TO_RADIAN);
 
 		if (radians) {
 			return wrapped;
@@ -195,14 +1466,43 @@ public:
 		}
 	}
 	inline double raw_heading(bool radians = false) {
-		std::lock_guard<pros::Mutex> guard(lock);
+		double theta = snapshot().theta;
         if (radians) {
-            return global_theta;
+            return theta;
         } else {
-            return global_theta * RADIAN_TO_DEGREE;
+            return theta * RADIAN_TO_DEGREE;
         }
 	}
 
+	// Distance each tracking wheel has rolled in cm.
+	inline double left_position() {
+		return left.get_position() / 36000.0 * diameter * M_PI;
+	}
+
+	inline double right_position() {
+		return right.get_position() / 36000.0 * diameter * M_PI;
+	}
+
+	// Tracking wheel speeds in cm/s.
+	inline double left_velocity() {
+		return left.get_velocity() / 360.0 * diameter * M_PI;
+	}
+
+	inline double right_velocity() {
+		return right.get_velocity() / 360.0 * diameter * M_PI;
+	}
+
+	// How fast the robot is turning by the tracking wheels' speeds, in
+	// degrees or radians per second.
+	inline double turn_rate(bool radians = false) {
+		double rate = (left_velocity() - right_velocity()) / trackwidth;
+		return radians ? rate : rate * RADIAN_TO_DEGREE;
+	}
+
+	inline double get_trackwidth() {
+		return trackwidth;
+	}
+
     inline double forward() {
         double l = left.get_position() / 36000.0 * diameter * M_PI;
         double r = right.get_position() / 36000.0 * diameter * M_PI;
@@ -210,29 +1510,70 @@ public:
     }
 
     inline double x() {
-        std::lock_guard<pros::Mutex> guard(lock);
-        return global_x;
+        return snapshot().x;
     }
 
     inline double y() {
-        std::lock_guard<pros::Mutex> guard(lock);
-        return global_y;
+        return snapshot().y;
     }
 
     inline Position position() {
-        std::lock_guard<pros::Mutex> guard(lock);
-		double wrapped_heading = std::fmod(global_theta, 360 * DEGREE_TO_RADIAN);
+        Pose pose = snapshot();
+		double wrapped_heading = std::fmod(pose.theta, 360 * DEGREE_TO_RADIAN);
 
         return Position {
-            global_x,
-            global_y,
+            pose.x,
+            pose.y,
             wrapped_heading,
             wrapped_heading * RADIAN_TO_DEGREE
         };
     }
 
-	inline static std::unique_ptr<Odom> create(pros::Rotation ileft, pros::Rotation iright, double idiameter, double itrackwidth) {
-		return std::make_unique<Odom>(ileft, iright, idiameter, itrackwidth);
+    inline unsigned long get_interval() {
+        return interval;
+    }
+
+    // Whether the heading currently comes from the IMU fused with the wheels.
+    inline bool fused() {
+        return filter && filter->fused();
+    }
+
+    // Corrects the pose from absolute sensors from the next cycle on,
+    // replacing any Localizer given before.
+    inline void localize(std::unique_ptr<Localizer> ilocalizer) {
+        delete incoming.exchange(ilocalizer.release(), std::memory_order_acq_rel);
+    }
+
+    // The Localizer in use, or nullptr. It lives as long as the Odom or
+    // until the next localize().
+    inline Localizer* get_localizer() {
+        return active.load(std::memory_order_acquire);
+    }
+
+    // Mean and worst lateness of a loop wake-up against its deadline, in ms.
+    inline double jitter() {
+        uint32_t count = cycles.load(std::memory_order_relaxed);
+        return count == 0 ? 0 : jitter_total.load(std::memory_order_relaxed) / 1000.0 / count;
+    }
+
+    inline double max_jitter() {
+        return jitter_max.load(std::memory_order_relaxed) / 1000.0;
+    }
+
+	inline static std::unique_ptr<Odom> create(pros::Rotation ileft, pros::Rotation iright, double idiameter, double itrackwidth, unsigned long iinterval = 20) {
+		return std::make_unique<Odom>(ileft, iright, idiameter, itrackwidth, iinterval);
+	}
+
+	inline static std::unique_ptr<Odom> create(pros::Rotation ileft, pros::Rotation iright, pros::Imu iimu, double idiameter, double itrackwidth, unsigned long iinterval = 20) {
+		return std::make_unique<Odom>(ileft, iright, iimu, idiameter, itrackwidth, iinterval);
+	}
+
+	inline static std::unique_ptr<Odom> create(pros::Rotation ileft, pros::Rotation iright, pros::Rotation iback, double idiameter, double itrackwidth, double iback_offset, unsigned long iinterval = 20) {
+		return std::make_unique<Odom>(ileft, iright, iback, idiameter, itrackwidth, iback_offset, iinterval);
+	}
+
+	inline static std::unique_ptr<Odom> create(pros::Rotation ileft, pros::Rotation iright, pros::Rotation iback, pros::Imu iimu, double idiameter, double itrackwidth, double iback_offset, unsigned long iinterval = 20) {
+		return std::make_unique<Odom>(ileft, iright, iback, iimu, idiameter, itrackwidth, iback_offset, iinterval);
 	}
 };
 
@@ -242,13 +1583,20 @@ public:
 	std::unique_ptr<PID> turn;
 	std::unique_ptr<PID> angle;
 	std::unique_ptr<Odom> odom;
+	// Drive model for trajectories: mV on both sides per cm/s and cm/s^2,
+	// and mV added to the left and taken from the right per rad/s and rad/s^2.
+	std::unique_ptr<Feedforward> drive_feedforward;
+	std::unique_ptr<Feedforward> turn_feedforward;
+	// Per-side speed loops on the tracking wheels for Robot::track_velocity.
+	std::unique_ptr<VelocityController> left_velocity;
+	std::unique_ptr<VelocityController> right_velocity;
 
-	Controllers(std::unique_ptr<PID> idrive, std::unique_ptr<PID> iturn, std::unique_ptr<PID> iangle, std::unique_ptr<Odom> iodom) :
-	drive(std::move(idrive)), turn(std::move(iturn)), angle(std::move(iangle)), odom(std::move(iodom)) {
+	Controllers(std::unique_ptr<PID> idrive, std::unique_ptr<PID> iturn, std::unique_ptr<PID> iangle, std::unique_ptr<Odom> iodom, std::unique_ptr<Feedforward> idrive_feedforward = nullptr, std::unique_ptr<Feedforward> iturn_feedforward = nullptr, std::unique_ptr<VelocityController> ileft_velocity = nullptr, std::unique_ptr<VelocityController> iright_velocity = nullptr) :
+	drive(std::move(idrive)), turn(std::move(iturn)), angle(std::move(iangle)), odom(std::move(iodom)), drive_feedforward(std::move(idrive_feedforward)), turn_feedforward(std::move(iturn_feedforward)), left_velocity(std::move(ileft_velocity)), right_velocity(std::move(iright_velocity)) {
 	}
 
-	inline static std::unique_ptr<Controllers> create(std::unique_ptr<PID> idrive, std::unique_ptr<PID> iturn, std::unique_ptr<PID> iangle, std::unique_ptr<Odom> iodom) {
-		return std::make_unique<Controllers>(std::move(idrive), std::move(iturn), std::move(iangle), std::move(iodom));
+	inline static std::unique_ptr<Controllers> create(std::unique_ptr<PID> idrive, std::unique_ptr<PID> iturn, std::unique_ptr<PID> iangle, std::unique_ptr<Odom> iodom, std::unique_ptr<Feedforward> idrive_feedforward = nullptr, std::unique_ptr<Feedforward> iturn_feedforward = nullptr, std::unique_ptr<VelocityController> ileft_velocity = nullptr, std::unique_ptr<VelocityController> iright_velocity = nullptr) {
+		return std::make_unique<Controllers>(std::move(idrive), std::move(iturn), std::move(iangle), std::move(iodom), std::move(idrive_feedforward), std::move(iturn_feedforward), std::move(ileft_velocity), std::move(iright_velocity));
 	}
 };
 
@@ -264,14 +1612,16 @@ class Chassis {
 	double voltage_max = 12000;
 	double velocity_max = 200;
 
+	const double track_width;
+
 	inline double exp_drive(int32_t power, int32_t exponent) {
 		auto value = std::pow((power / 127.0), exponent) / static_cast<double>(std::pow(1, exponent - 1));
     	return value  * 127;
 	}
 
 public:
-	Chassis(std::initializer_list<int8_t> ileft, std::initializer_list<int8_t> iright, double iexp_power = 1, double iexp_turn = 1) : 
-	left(ileft), right(iright), exp_power(iexp_power), exp_turn(iexp_turn) {
+	Chassis(std::initializer_list<int8_t> ileft, std::initializer_list<int8_t> iright, double itrack_width, double iexp_power = 1, double iexp_turn = 1) : 
+	left(ileft), right(iright), exp_power(iexp_power), exp_turn(iexp_turn), track_width(itrack_width) {
 	};
 
 	inline void set_voltage_max(double max) {
@@ -302,6 +1652,29 @@ public:
 		right.move_velocity(std::clamp((power - turn) * velocity_percent, -velocity_max, velocity_max));
 	}
 
+	// Drives an arc of the given curvature, in 1/cm and positive clockwise
+	// as seen facing forward. Both sides slow together when one would pass
+	// voltage_max, so the arc holds at any power.
+	inline void move_curvature(int32_t power, double curvature) {
+		double turn = power * curvature * track_width / 2.0;
+		double peak = std::abs(power) + std::abs(turn);
+		double scale = peak > voltage_max ? voltage_max / peak : 1;
+		move_voltage(power * scale, turn * scale);
+	}
+
+	// Each side on its own voltage, both scaled back together when one would
+	// pass voltage_max.
+	inline void move_tank(int32_t left_voltage, int32_t right_voltage) {
+		double peak = std::max(std::abs(left_voltage), std::abs(right_voltage));
+		double scale = peak > voltage_max ? voltage_max / peak : 1;
+		left.move_voltage(left_voltage * scale * voltage_percent);
+		right.move_voltage(right_voltage * scale * voltage_percent);
+	}
+
+	inline double get_track_width() {
+		return track_width;
+	}
+
 	inline void drive_voltage(int32_t voltage) {
 		move_voltage(voltage, 0);
 	}
@@ -334,8 +1707,8 @@ public:
 		right.set_brake_modes(mode);
 	}
 
-	inline static std::unique_ptr<Chassis> create(std::initializer_list<int8_t> ileft, std::initializer_list<int8_t> iright, double iexp_power = 1, double iexp_turn = 1) {
-		return std::make_unique<Chassis>(ileft, iright, iexp_power, iexp_turn);
+	inline static std::unique_ptr<Chassis> create(std::initializer_list<int8_t> ileft, std::initializer_list<int8_t> iright, double itrack_width, double iexp_power = 1, double iexp_turn = 1) {
+		return std::make_unique<Chassis>(ileft, iright, itrack_width, iexp_power, iexp_turn);
 	};
 };
 
@@ -372,19 +1745,91 @@ public:
 };
 
 class Flywheel {
+public:
+	// How the loop drives the motors. pidf runs the PID on the filtered motor
+	// velocity. The rest read the rotation sensor: bangbang is full voltage
+	// below the target and none above it, hold is bang-bang outside
+	// HOLD_BAND rpm of the target and the PID's feedforward and P term inside
+	// it, tbh is take-back-half seeded with the feedforward, and lqr runs the
+	// StateSpace controller on the sensor and the motor velocity together.
+	enum class Mode { pidf, bangbang, hold, tbh, lqr };
+
+	static constexpr double HOLD_BAND = 60;    // rpm either side of the target
+	static constexpr double TBH_GAIN = 2;      // mV per rpm of error per interval
+	static constexpr double READY_BAND = 40;   // rpm either side of the target to fire
+	static constexpr double READY_RATE = 1500; // rpm/s it may still be changing by to fire
+	static constexpr double RATE_ALPHA = 0.5;  // smoothing on the measured rate of change
+	static constexpr double RETARGET_STEP = 20; // rpm a followed target moves by before it is taken
+
+	// Voltage added for each disc the Indexer fires, from SHOT_LEAD ms after
+	// the piston extends for SHOT_LENGTH ms. The motors cannot put back a
+	// disc's worth of speed during the contact alone, so the boost runs full
+	// voltage across it; starting it just before the disc arrives keeps the
+	// speed at contact on the target, which is what the shot map assumes,
+	// rather than banking extra that sends the disc long. hbot_flywheel
+	// checks the contact speed.
+	static constexpr double SHOT_BOOST = 12000;
+	static constexpr std::uint32_t SHOT_LEAD = 25;
+	static constexpr std::uint32_t SHOT_LENGTH = 40;
+
+private:
 	pros::MotorGroup motors;
 	pros::Rotation sensor;
 	std::unique_ptr<PID> controller;
+	std::unique_ptr<StateSpace> model;
+	std::function<double()> source;
 
-    pros::Task thread;
     pros::Mutex lock;
 
 	bool enabled = false;
-	bool bangbang = false;
+	Mode mode = Mode::pidf;
 
-	double prev_pos = 0;
 	double prev_vel = 0;
 
+	double prev_rpm = 0;
+	double acceleration = 0;  // rpm/s off the rotation sensor, smoothed
+
+	// Take-back-half state: the voltage it integrates, the voltage it last
+	// took back to, the sign of the error at the last step and whether it
+	// has crossed the target since the last reset.
+	double tbh_output = 0;
+	double tbh_held = 0;
+	bool tbh_below = true;
+	bool tbh_crossed = false;
+	double tbh_gain = TBH_GAIN;
+
+	double shot_boost = SHOT_BOOST;
+	std::uint32_t shot_lead = SHOT_LEAD;
+	std::uint32_t shot_length = SHOT_LENGTH;
+	std::uint32_t fired_at = 0;
+	bool shot = false;
+
+	// Last, so the task cannot run loop() before the state it reads exists.
+    pros::Task thread;
+
+	inline double boost() {
+		if (!shot) {
+			return 0;
+		}
+		std::uint32_t since = pros::millis() - fired_at;
+		if (since >= shot_lead + shot_length) {
+			shot = false;
+			return 0;
+		}
+		return since >= shot_lead ? shot_boost : 0;
+	}
+
+	inline double feedforward() {
+		return controller->get_kb() + controller->get_kf() * controller->get_setpoint();
+	}
+
+	inline void reset_tbh() {
+		tbh_held = feedforward();
+		tbh_output = tbh_held;
+		tbh_below = rpm() < controller->get_setpoint();
+		tbh_crossed = false;
+	}
+
     void loop() {
         unsigned long interval = controller->get_interval();
 		auto interval_in_sec = interval / 1000.0;
@@ -393,32 +1838,72 @@ class Flywheel {
 
         while (true) {
             std::unique_lock<pros::Mutex> guard(lock);
-        
-            if (enabled) {
-				if (bangbang) {
-					double reading = (sensor.get_velocity() / 360.0 * 60.0);
-					double setpoint = controller->get_setpoint();
-					double diff = setpoint - reading;
 
-				} else {
-					double pos = sensor.get_position();
-					double delta_pos = (pos - prev_pos) / interval_in_sec;
+			double reading = rpm();
+			acceleration += RATE_ALPHA * ((reading - prev_rpm) / interval_in_sec - acceleration);
+			prev_rpm = reading;
 
-					double vel = (sensor.get_velocity() / 360.0 * 60.0);
-					double accel = (vel - prev_vel) / interval_in_sec;
+			if (source) {
+				double target = source();
+				if (std::abs(target - controller->get_setpoint()) >= RETARGET_STEP) {
+					controller->target(target);
+					reset_tbh();
+				}
+			}
+        
+            if (enabled) {
+				double setpoint = controller->get_setpoint();
+				double diff = setpoint - sensor.get_velocity() / 360.0 * 60.0;
+				double voltage = 0;
+				double kick = boost();
+
+				switch (mode) {
+				case Mode::bangbang:
+					voltage = diff > 0 ? 12000 : 0;
+					break;
+				case Mode::hold:
+					if (std::abs(diff) > HOLD_BAND) {
+						voltage = diff > 0 ? 12000 : 0;
+					} else {
+						voltage = std::clamp(feedforward() + controller->get_kp() * diff, 0.0, 12000.0);
+					}
+					break;
+				case Mode::tbh:
+					// Integrate the error, and each time it changes sign take
+					// the voltage back to halfway to where it last crossed.
+					// The first crossing after a reset drops straight to the
+					// feedforward, which is most of the way there.
+					tbh_output = std::clamp(tbh_output + tbh_gain * diff, 0.0, 12000.0);
+					if ((diff > 0) != tbh_below) {
+						tbh_output = tbh_held = tbh_crossed ? (tbh_output + tbh_held) / 2 : tbh_held;
+						tbh_below = diff > 0;
+						tbh_crossed = true;
+					}
+					voltage = tbh_output;
+					break;
+				case Mode::lqr:
+					voltage = model->step(setpoint, setpoint - diff, motors.get_actual_velocities().at(0) * 18.0, kick);
+					kick = 0;
+					break;
+				case Mode::pidf: {
+					// For the log line below, which fit_flywheel.py reads.
+					[[maybe_unused]] double vel = (sensor.get_velocity() / 360.0 * 60.0);
+					[[maybe_unused]] double accel = (vel - prev_vel) / interval_in_sec;
 
 					auto mreading = motors.get_actual_velocities().at(0) * 18.0;
 					filtered = (alpha * mreading) + (1.0 - alpha) * filtered;
 
-                	double voltage = std::clamp(controller->step(filtered), 0.0, 12000.0);
-					pros::lcd::print(6, "MV: %f", voltage);
+                	voltage = std::clamp(controller->step(filtered), 0.0, 12000.0);
 					//std::cout << controller->get_setpoint() << "," << voltage << "," << vel << "," << accel << "\n";
-					
-					prev_pos = pos;
+
 					prev_vel = vel;
-					
-					motors.move_voltage(voltage);
+					break;
 				}
+				}
+
+				voltage = std::clamp(voltage + kick, 0.0, 12000.0);
+				pros::lcd::print(6, "MV: %f", voltage);
+				motors.move_voltage(voltage);
             } else {
                 motors.move_voltage(0);
             }
@@ -429,15 +1914,29 @@ class Flywheel {
     }
 
 public:
-	Flywheel(std::initializer_list<int8_t> imotors, pros::Rotation isensor, std::unique_ptr<PID> icontroller) : 
-	motors(imotors), sensor(isensor), controller(std::move(icontroller)), thread([&] { this->loop(); }) {
+	Flywheel(std::initializer_list<int8_t> imotors, pros::Rotation isensor, std::unique_ptr<PID> icontroller, std::unique_ptr<StateSpace> imodel = nullptr) : 
+	motors(imotors), sensor(isensor), controller(std::move(icontroller)), model(std::move(imodel)), thread([&] { this->loop(); }) {
         sensor.set_data_rate(10);
 		
 	}
 
 	inline void move(double rpm) {
         std::lock_guard<pros::Mutex> guard(lock);
+		source = nullptr;
         controller->target(rpm);
+		reset_tbh();
+	}
+
+	// Retargets every interval to what target returns, once it has moved by
+	// RETARGET_STEP, until the next move or follow. target runs on the
+	// flywheel task with its lock held, so must not call back into it.
+	inline void follow(std::function<double()> target) {
+		std::lock_guard<pros::Mutex> guard(lock);
+		source = std::move(target);
+		if (source) {
+			controller->target(source());
+			reset_tbh();
+		}
 	}
 
 	inline void enable() {
@@ -464,12 +1963,73 @@ public:
         return sensor.get_velocity() / 360.0 * 60.0;
     }
 
+	// lqr needs the StateSpace model; without one it stays in its mode.
+	inline void use(Mode new_mode) {
+		std::lock_guard<pros::Mutex> guard(lock);
+		if (new_mode == Mode::lqr && !model) {
+			return;
+		}
+		if (new_mode == Mode::tbh && mode != Mode::tbh) {
+			reset_tbh();
+		}
+		if (new_mode == Mode::lqr && mode != Mode::lqr) {
+			model->reset(rpm());
+		}
+		mode = new_mode;
+	}
+
+	inline Mode get_mode() {
+		std::lock_guard<pros::Mutex> guard(lock);
+		return mode;
+	}
+
 	inline void use_bangbang() {
-		bangbang = true;
+		use(Mode::bangbang);
+	}
+
+	inline void use_hold() {
+		use(Mode::hold);
+	}
+
+	inline void use_tbh(double gain = TBH_GAIN) {
+		use(Mode::tbh);
+		std::lock_guard<pros::Mutex> guard(lock);
+		tbh_gain = gain;
 	}
 
 	inline void use_pidf() {
-		bangbang = false;
+		use(Mode::pidf);
+	}
+
+	inline void use_lqr() {
+		use(Mode::lqr);
+	}
+
+	// Called by the Indexer as it fires; times the shot boost from now.
+	inline void fired() {
+		std::lock_guard<pros::Mutex> guard(lock);
+		fired_at = pros::millis();
+		shot = true;
+	}
+
+	inline void set_shot_boost(double voltage, std::uint32_t lead, std::uint32_t length) {
+		std::lock_guard<pros::Mutex> guard(lock);
+		shot_boost = voltage;
+		shot_lead = lead;
+		shot_length = length;
+	}
+
+	// rpm per second, positive while speeding up.
+	inline double get_acceleration() {
+		std::lock_guard<pros::Mutex> guard(lock);
+		return acceleration;
+	}
+
+	// Spinning, within band rpm of the target and changing by less than rate
+	// rpm/s, so the speed will still be there when the disc arrives.
+	inline bool ready(double band = READY_BAND, double rate = READY_RATE) {
+		std::lock_guard<pros::Mutex> guard(lock);
+		return enabled && std::abs(rpm() - controller->get_setpoint()) < band && std::abs(acceleration) < rate;
 	}
 
 	inline double get_reading() {
@@ -477,22 +2037,83 @@ public:
 		return sensor.get_velocity() / 360.0 * 60.0;
 	}
 
-	inline static std::unique_ptr<Flywheel> create(std::initializer_list<int8_t> imotors, pros::Rotation isensor, std::unique_ptr<PID> icontroller) {
-		return std::make_unique<Flywheel>(imotors, isensor, std::move(icontroller));
+	inline static std::unique_ptr<Flywheel> create(std::initializer_list<int8_t> imotors, pros::Rotation isensor, std::unique_ptr<PID> icontroller, std::unique_ptr<StateSpace> imodel = nullptr) {
+		return std::make_unique<Flywheel>(imotors, isensor, std::move(icontroller), std::move(imodel));
 	}
 };
 
 class Indexer {
+public:
+	// How ready the flywheel must be before a disc fires, and the longest to
+	// wait for it before firing anyway.
+	struct Readiness {
+		double band = Flywheel::READY_BAND;  // rpm either side of the target
+		double rate = Flywheel::READY_RATE;  // rpm/s
+		unsigned long timeout = 1000;        // ms
+	};
+
+	static constexpr unsigned long RELOAD = 150;  // ms
+	static constexpr unsigned long POLL = 5;      // ms
+
+private:
 	pros::ADIDigitalOut piston;
 	const unsigned long delay;
 	const unsigned long interval;
+
+	std::vector<std::function<void()>> listeners;
+	std::function<bool(double band, double rate)> gate;
+	std::vector<unsigned long> waits;
+
+	// Waits at least minimum ms, then until the gate passes or timeout ms
+	// have gone by. Without a gate there is nothing to wait for past the
+	// minimum. Returns the time waited.
+	inline unsigned long wait(const Readiness& readiness, unsigned long minimum) {
+		std::uint32_t start = pros::millis();
+		pros::delay(std::min(minimum, readiness.timeout));
+		if (!gate) {
+			return pros::millis() - start;
+		}
+		while (!gate(readiness.band, readiness.rate) && pros::millis() - start < readiness.timeout) {
+			pros::delay(POLL);
+		}
+		return pros::millis() - start;
+	}
+
+	// Between discs in a repeat: the whole interval, or with a gate until it
+	// passes, at least RELOAD ms for the next disc to drop in and at most the
+	// interval.
+	inline void wait(unsigned long interval) {
+		if (!gate) {
+			pros::delay(interval);
+			return;
+		}
+		Readiness readiness;
+		readiness.timeout = interval;
+		wait(readiness, RELOAD);
+	}
 public:
 	Indexer(pros::ADIDigitalOut ipiston, unsigned long idelay, unsigned long iinterval) :
 	piston(ipiston), delay(idelay), interval(iinterval) {
 	}
 
+	// listener runs on the firing task each time the piston extends.
+	inline void on_fire(std::function<void()> listener) {
+		listeners.push_back(std::move(listener));
+	}
+
+	// ready(band, rate) says whether the flywheel is within band rpm of its
+	// target and changing by less than rate rpm/s. repeat holds between discs
+	// until it passes, so the interval becomes the longest wait instead of a
+	// fixed one, and repeat_ready fires on it alone.
+	inline void set_gate(std::function<bool(double band, double rate)> ready) {
+		gate = std::move(ready);
+	}
+
 	inline void extend() {
 		piston.set_value(true);
+		for (auto& listener : listeners) {
+			listener();
+		}
 	}
 
 	inline void retract() {
@@ -514,7 +2135,7 @@ public:
 	inline void repeat(int times) {
 		for(int i = 0; i < times - 1; i++) {
 			index();
-			pros::delay(interval);
+			wait(interval);
 		}
 		index();
 	}
@@ -522,7 +2143,7 @@ public:
 	inline void repeat(int times, unsigned long interval) {
 		for(int i = 0; i < times - 1; i++) {
 			index();
-			pros::delay(interval);
+			wait(interval);
 		}
 		index();
 	}
@@ -530,12 +2151,43 @@ public:
 	inline void repeat(int times, unsigned long interval, unsigned long delay) {
 		for(int i = 0; i < times - 1; i++) {
 			index(delay);
-			pros::delay(interval);
+			wait(interval);
 			std::cout << "waited interval\n";
 		}
 		index(delay);
 	}
 
+	// Fires each disc as soon as the gate says the flywheel is ready for it,
+	// the first included, holding each for delay ms. Without a gate the first
+	// fires at once and the rest every RELOAD ms. Logs how long each disc
+	// waited; get_waits has them until the next volley.
+	inline void repeat_ready(int times, unsigned long delay, Readiness readiness) {
+		waits.clear();
+		for (int i = 0; i < times; i++) {
+			unsigned long waited = wait(readiness, i == 0 ? 0 : RELOAD);
+			waits.push_back(waited);
+			LOG("[Indexer] Disc " << i + 1 << " waited " << waited << " ms"
+			    << (waited >= readiness.timeout ? ", timed out" : "") << "\n");
+			index(delay);
+		}
+	}
+
+	inline void repeat_ready(int times, Readiness readiness) {
+		repeat_ready(times, delay, readiness);
+	}
+
+	inline void repeat_ready(int times, unsigned long delay) {
+		repeat_ready(times, delay, Readiness());
+	}
+
+	inline void repeat_ready(int times) {
+		repeat_ready(times, delay, Readiness());
+	}
+
+	inline const std::vector<unsigned long>& get_waits() {
+		return waits;
+	}
+
 	inline static std::unique_ptr<Indexer> create(pros::ADIDigitalOut ipiston, unsigned long idelay, unsigned long iinterval) {
 		return std::make_unique<Indexer>(ipiston, idelay, iinterval);
 	}
@@ -554,22 +2206,130 @@ public:
 		piston.set_value(true);
 	}
 
-	inline void retract() {
-		extended = false;
-		piston.set_value(false);
+	inline void retract() {
+		extended = false;
+		piston.set_value(false);
+	}
+
+	inline void toggle() {
+		extended = !extended;
+		piston.set_value(extended);
+	}
+
+	inline bool toggled() {
+		return extended;
+	}
+
+	inline static std::unique_ptr<Anglechg> create(pros::ADIDigitalOut ipiston) {
+		return std::make_unique<Anglechg>(ipiston);
+	}
+};
+
+// Flywheel speed for a shot from a distance to the goal, with one table for
+// each Anglechg state. Between points it follows a monotone cubic
+// (Fritsch-Carlson), so a table that rises with distance never overshoots
+// between its points; beyond the ends it holds the end speed.
+class ShotMap {
+public:
+	struct Point {
+		double distance;  // cm
+		double rpm;
+	};
+
+private:
+	struct Curve {
+		std::vector<Point> points;
+		std::vector<double> slopes;  // rpm per cm at each point
+	};
+
+	Curve normal;
+	Curve angled;
+
+	// Points may come in any order. Ones at the same distance are averaged
+	// into one, since two speeds there would give a segment no width, and
+	// ones that are not finite are dropped.
+	inline static Curve fit(std::vector<Point> given) {
+		given.erase(std::remove_if(given.begin(), given.end(), [](const Point& p) {
+			return !std::isfinite(p.distance) || !std::isfinite(p.rpm);
+		}), given.end());
+		std::sort(given.begin(), given.end(), [](const Point& a, const Point& b) { return a.distance < b.distance; });
+		std::vector<Point> points;
+		for (std::size_t i = 0; i < given.size();) {
+			std::size_t j = i;
+			double total = 0;
+			for (; j < given.size() && given[j].distance == given[i].distance; j++) {
+				total += given[j].rpm;
+			}
+			if (j - i > 1) {
+				LOG("[ShotMap] Averaged " << j - i << " points at " << given[i].distance << " cm\n");
+			}
+			points.push_back({given[i].distance, total / (j - i)});
+			i = j;
+		}
+		std::size_t n = points.size();
+		std::vector<double> secants;
+		for (std::size_t i = 0; i + 1 < n; i++) {
+			secants.push_back((points[i + 1].rpm - points[i].rpm) / (points[i + 1].distance - points[i].distance));
+		}
+		std::vector<double> slopes(n, 0);
+		for (std::size_t i = 0; i < n; i++) {
+			if (i == 0 || i == n - 1) {
+				slopes[i] = secants.empty() ? 0 : secants[i == 0 ? 0 : n - 2];
+			} else if (secants[i - 1] * secants[i] > 0) {
+				slopes[i] = (secants[i - 1] + secants[i]) / 2;
+			}
+		}
+		// Limit the slopes so no segment can leave the range of its ends.
+		for (std::size_t i = 0; i + 1 < n; i++) {
+			if (secants[i] == 0) {
+				slopes[i] = slopes[i + 1] = 0;
+				continue;
+			}
+			double a = slopes[i] / secants[i];
+			double b = slopes[i + 1] / secants[i];
+			if (a * a + b * b > 9) {
+				double t = 3 / std::sqrt(a * a + b * b);
+				slopes[i] = t * a * secants[i];
+				slopes[i + 1] = t * b * secants[i];
+			}
+		}
+		return {points, slopes};
+	}
+
+	inline static double sample(const Curve& curve, double distance) {
+		auto& points = curve.points;
+		if (points.empty()) {
+			return 0;
+		}
+		if (distance <= points.front().distance) {
+			return points.front().rpm;
+		}
+		if (distance >= points.back().distance) {
+			return points.back().rpm;
+		}
+		std::size_t i = 0;
+		while (distance > points[i + 1].distance) {
+			i++;
+		}
+		double h = points[i + 1].distance - points[i].distance;
+		double t = (distance - points[i].distance) / h;
+		double t2 = t * t;
+		double t3 = t2 * t;
+		return (2 * t3 - 3 * t2 + 1) * points[i].rpm + (t3 - 2 * t2 + t) * h * curve.slopes[i] +
+		       (-2 * t3 + 3 * t2) * points[i + 1].rpm + (t3 - t2) * h * curve.slopes[i + 1];
 	}
 
-	inline void toggle() {
-		extended = !extended;
-		piston.set_value(extended);
+public:
+	ShotMap(std::vector<Point> inormal, std::vector<Point> iangled) :
+	normal(fit(std::move(inormal))), angled(fit(std::move(iangled))) {
 	}
 
-	inline bool toggled() {
-		return extended;
+	inline double rpm(double distance, bool angle_changed) const {
+		return sample(angle_changed ? angled : normal, distance);
 	}
 
-	inline static std::unique_ptr<Anglechg> create(pros::ADIDigitalOut ipiston) {
-		return std::make_unique<Anglechg>(ipiston);
+	inline static std::unique_ptr<ShotMap> create(std::vector<Point> inormal, std::vector<Point> iangled) {
+		return std::make_unique<ShotMap>(std::move(inormal), std::move(iangled));
 	}
 };
 
@@ -589,7 +2349,135 @@ public:
 	}
 };
 
+// Handle to a motion queued on Robot's chassis task. The task that queued it
+// carries on and can wait for points along the way to run the intake, fire
+// or flip the angle changer there.
+class Motion {
+public:
+	struct State {
+		std::function<void()> run;
+		std::atomic<bool> started{false};
+		std::atomic<bool> finished{false};
+		double start_forward = 0;
+		unsigned long start_time = 0;
+	};
+
+	static constexpr unsigned long POLL = 10;  // ms between checks while waiting
+
+private:
+	std::shared_ptr<State> state;
+	Odom* odom;
+
+public:
+	Motion(std::shared_ptr<State> istate, Odom* iodom) :
+	state(std::move(istate)), odom(iodom) {
+	}
+
+	inline bool started() {
+		return state->started.load(std::memory_order_acquire);
+	}
+
+	inline bool done() {
+		return state->finished.load(std::memory_order_acquire);
+	}
+
+	// cm the tracking wheels have rolled since the motion started, either
+	// way, so it counts along curves and in reverse but not turns in place.
+	inline double travelled() {
+		return started() ? std::abs(odom->forward() - state->start_forward) : 0;
+	}
+
+	inline unsigned long elapsed() {
+		return started() ? pros::millis() - state->start_time : 0;
+	}
+
+	// These return early if the motion finishes first.
+	inline void wait_until_dist(double cm) {
+		while (!done() && travelled() < cm) {
+			pros::delay(POLL);
+		}
+	}
+
+	inline void wait_until_time(unsigned long ms) {
+		while (!done() && (!started() || elapsed() < ms)) {
+			pros::delay(POLL);
+		}
+	}
+
+	inline void wait() {
+		while (!done()) {
+			pros::delay(POLL);
+		}
+	}
+};
+
 class Robot {
+	// Motions queued by the async calls, run one at a time on thread. While
+	// cancelling is set the motion loops exit at their next step.
+	std::deque<std::shared_ptr<Motion::State>> queue;
+	pros::Mutex lock;
+	std::atomic<bool> running{false};
+	std::atomic<bool> cancelling{false};
+	// Speeds hold_velocity has the task track while nothing is queued.
+	std::atomic<bool> holding{false};
+	std::atomic<double> hold_linear{0};
+	std::atomic<double> hold_angular{0};
+
+	void loop() {
+		while (true) {
+			std::unique_lock<pros::Mutex> guard(lock);
+			if (queue.empty()) {
+				// Holding counts as running, so cancel() waits out a step
+				// already past the check before it stops the chassis.
+				bool hold = holding;
+				running = hold;
+				guard.unlock();
+				if (hold) {
+					track_velocity(hold_linear, hold_angular);
+					running = false;
+				}
+				pros::delay(Motion::POLL);
+				continue;
+			}
+			auto motion = std::move(queue.front());
+			queue.pop_front();
+			running = true;
+			guard.unlock();
+
+			motion->start_forward = controllers->odom->forward();
+			motion->start_time = pros::millis();
+			motion->started.store(true, std::memory_order_release);
+			motion->run();
+			running = false;
+			motion->finished.store(true, std::memory_order_release);
+		}
+	}
+
+	// When track_velocity last ran, to time its integrals.
+	unsigned long velocity_time = 0;
+
+	// Drive and turn voltage a chained motion was still applying when it
+	// exited, and when, for the next motion to ease down from.
+	double carry_drive = 0;
+	double carry_turn = 0;
+	unsigned long carry_time = 0;
+
+	// Holds a motion's output at or above what the last chained motion left
+	// behind, letting it fall by at most CHAIN_SLEW mV per ms since the exit
+	// so the robot does not brake between the two.
+	inline double carry_over(double output, double carry) {
+		double floor = std::abs(carry) - CHAIN_SLEW * (pros::millis() - carry_time);
+		if (floor <= 0 || std::signbit(output) != std::signbit(carry)) {
+			return output;
+		}
+		return std::copysign(std::max(std::abs(output), floor), carry);
+	}
+
+	// Whether the last chained motion's voltage has not yet run out.
+	inline bool carrying() {
+		return std::max(std::abs(carry_drive), std::abs(carry_turn)) > CHAIN_SLEW * (pros::millis() - carry_time);
+	}
+
 	inline double constrain_angle_180(double degrees) {
 		degrees = std::fmod(degrees, 360); 
 		degrees = std::fmod((degrees + 360), 360);  
@@ -602,8 +2490,9 @@ class Robot {
 		double target_x = x;
 		double target_y = y;
 
-		double current_x = controllers->odom->x();
-		double current_y = controllers->odom->y();
+		auto current = controllers->odom->position();
+		double current_x = current.x;
+		double current_y = current.y;
 
 		double angle = std::atan2(target_y - current_y, target_x - current_x) * RADIAN_TO_DEGREE;
 		
@@ -616,14 +2505,42 @@ class Robot {
 		double target_x = x;
 		double target_y = y;
 
-		double current_x = controllers->odom->x();
-		double current_y = controllers->odom->y();
+		auto current = controllers->odom->position();
+		double current_x = current.x;
+		double current_y = current.y;
 
 		double dist = std::hypot(target_x - current_x, target_y - current_y);
 		if (reverse) { dist = -dist; };
 
 		return dist;
 	}
+
+	// One RAMSETE step: the reference velocity and turn rate, corrected for
+	// where Odom says the robot is against the reference pose, drive the
+	// sides through the feedforwards. In cm, radians and seconds.
+	inline void ramsete_step(double x, double y, double yaw, double velocity, double acceleration, double angular, double angular_acceleration, bool reverse) {
+		// Error in the robot's frame, facing the way it drives.
+		auto pose = controllers->odom->position();
+		double facing = pose.theta + (reverse ? M_PI : 0);
+		double dx = x - pose.x;
+		double dy = y - pose.y;
+		double ahead = dx * std::cos(facing) + dy * std::sin(facing);
+		double aside = dy * std::cos(facing) - dx * std::sin(facing);
+		double turn = std::remainder(yaw - facing, 2 * M_PI);
+
+		double gain = 2 * RAMSETE_ZETA * std::sqrt(angular * angular + RAMSETE_B * velocity * velocity);
+		double sinc = std::abs(turn) < 1e-6 ? 1 : std::sin(turn) / turn;
+		double linear = velocity * std::cos(turn) + gain * ahead;
+		angular += gain * turn + RAMSETE_B * velocity * sinc * aside;
+		if (reverse) {
+			linear = -linear;
+			acceleration = -acceleration;
+		}
+
+		double power = controllers->drive_feedforward->calculate(linear, acceleration);
+		double turning = controllers->turn_feedforward->calculate(angular, angular_acceleration);
+		chassis->move_tank(power + turning, power - turning);
+	}
 public:
 	std::unique_ptr<Chassis> chassis;
 	std::unique_ptr<Controllers> controllers;
@@ -632,36 +2549,109 @@ public:
 	std::unique_ptr<Indexer> indexer;
 	std::unique_ptr<Anglechg> anglechg;
 	std::unique_ptr<Endgame> endgame;
-
+	std::unique_ptr<ShotMap> shot_map;
+private:
+	// Last, so the task cannot run loop() before the members it uses exist.
+	pros::Task thread;
+public:
 	Robot(std::unique_ptr<Chassis> ichassis, 
 	std::unique_ptr<Controllers> icontrollers, 
 	std::unique_ptr<Intake> iintake,
 	std::unique_ptr<Flywheel> iflywheel,
 	std::unique_ptr<Indexer> iindexer,
 	std::unique_ptr<Anglechg> ianglechg,
-	std::unique_ptr<Endgame> iendgame) :
+	std::unique_ptr<Endgame> iendgame,
+	std::unique_ptr<ShotMap> ishot_map = nullptr) :
 	chassis(std::move(ichassis)), 
 	controllers(std::move(icontrollers)),
 	intake(std::move(iintake)),
 	flywheel(std::move(iflywheel)),
 	indexer(std::move(iindexer)),
 	anglechg(std::move(ianglechg)),
-	endgame(std::move(iendgame)) {
+	endgame(std::move(iendgame)),
+	shot_map(std::move(ishot_map)),
+	thread([&] { this->loop(); }) {
+		indexer->on_fire([this] { flywheel->fired(); });
+		indexer->set_gate([this](double band, double rate) { return flywheel->ready(band, rate); });
+	}
+
+	inline double distance_to(double x, double y) {
+		auto pos = controllers->odom->position();
+		return std::hypot(x - pos.x, y - pos.y);
 	}
 
-	inline void drive_dist_timeout(double cm, unsigned long timeout, double error_threshold = 2, unsigned long required_time = 250) {
+	// Keeps the flywheel at the shot map's speed for the distance from here
+	// to the goal at (x, y), following the Anglechg, while the robot drives,
+	// so it is already at speed on arrival. Flywheel::move ends it.
+	inline void aim_at(double x, double y) {
+		if (!shot_map) {
+			LOG("[ShotMap] No shot map, holding the flywheel's target\n");
+			return;
+		}
+		LOG("[ShotMap] Aiming at (" << x << ", " << y << ")\n");
+		flywheel->follow([this, x, y] { return shot_map->rpm(distance_to(x, y), anglechg->toggled()); });
+	}
+
+	// Queues a motion on the chassis task and returns without waiting. Later
+	// calls run after it in order. Blocking motions must not be mixed in
+	// until the handle's wait() returns, since both would drive the chassis.
+	inline Motion async(std::function<void()> motion) {
+		auto state = std::make_shared<Motion::State>();
+		state->run = std::move(motion);
+		std::lock_guard<pros::Mutex> guard(lock);
+		holding = false;
+		queue.push_back(state);
+		return Motion(state, controllers->odom.get());
+	}
+
+	// Drops every queued motion, stops the one running and waits for the
+	// chassis task to let go of the drive.
+	inline void cancel() {
+		std::unique_lock<pros::Mutex> guard(lock);
+		for (auto& motion : queue) {
+			motion->finished.store(true, std::memory_order_release);
+		}
+		queue.clear();
+		holding = false;
+		cancelling = true;
+		guard.unlock();
+		while (running) {
+			pros::delay(Motion::POLL);
+		}
+		cancelling = false;
+		chassis->stop();
+	}
+
+	// How fast a chained motion's output may fall from the one before it, in
+	// mV per ms.
+	static constexpr double CHAIN_SLEW = 30;
+
+	// Drives cm straight ahead. With an exit_radius the move is chained: it
+	// keeps at least exit_speed mV on the motors, ends as soon as it is
+	// within exit_radius cm of the target without stopping or settling, and
+	// hands its voltage to the next motion.
+	inline void drive_dist_timeout(double cm, unsigned long timeout, double error_threshold = 2, unsigned long required_time = 250, double exit_radius = 0, double exit_speed = 0) {
 		LOG("[PID] Driving " << cm << " cm\n");
 
 		double straight = controllers->odom->heading();
         double offset = controllers->odom->forward();
         controllers->drive->target(cm);
         unsigned long interval = controllers->drive->get_interval();
+		double power = 0;
         
         bool settling = false;
         unsigned long settled_time = 0;
 		unsigned long start_time = pros::millis();
 
         while (true) {
+			if (exit_radius > 0 && std::abs(controllers->drive->get_error()) < exit_radius) {
+				carry_drive = power;
+				carry_turn = 0;
+				carry_time = pros::millis();
+				LOG("[PID] Passed through at " << controllers->drive->get_error() << " cm error.\n");
+				return;
+			}
+
             if (!settling && std::abs(controllers->drive->get_error()) < error_threshold) {
                 settled_time = pros::millis();
                 settling = true;
@@ -680,16 +2670,21 @@ public:
             }
 
 			unsigned long current_time = pros::millis();
-			if(current_time - start_time > timeout) {
+			if(current_time - start_time > timeout || cancelling) {
 				break;
 			}
 
             double dist = controllers->odom->forward() - offset;
 			double drift = constrain_angle_180(controllers->odom->heading() - straight);
 
-            double power = controllers->drive->step(dist);
+            power = controllers->drive->step(dist);
 			double turn = controllers->angle->step(drift);
 
+			if (exit_radius > 0 && std::abs(power) < exit_speed) {
+				power = std::copysign(exit_speed, controllers->drive->get_error());
+			}
+			power = carry_over(power, carry_drive);
+
 
 			//std::cout << controllers->drive->get_setpoint() << "," << controllers->drive->get_reading() << "\n";
 
@@ -705,19 +2700,107 @@ public:
         drive_dist_timeout(cm, LONG_MAX, error_threshold, required_time);
     }
 
-	inline void turn_angle_timeout(double degrees, unsigned long timeout, double error_threshold = 2, unsigned long required_time = 100) {
+	// Chains into whatever motion comes next instead of stopping at cm.
+	inline void drive_dist_chained(double cm, double exit_radius = 5, double exit_speed = 3000) {
+		drive_dist_timeout(cm, LONG_MAX, 2, 0, exit_radius, exit_speed);
+	}
+
+	// Limits for drive_dist_profiled in cm/s, cm/s^2 and cm/s^3.
+	static constexpr double PROFILE_VELOCITY = 160;
+	static constexpr double PROFILE_ACCELERATION = 400;
+	static constexpr double PROFILE_JERK = 4000;
+
+	// Drives cm straight ahead along a motion profile, a trapezoid when
+	// max_jerk is 0 and an S-curve otherwise. The drive feedforward follows
+	// the profile's velocity and acceleration and the drive PID only corrects
+	// how far the robot is from where the profile says it should be, so the
+	// motors never see a full-error step. Settles like drive_dist_timeout
+	// once the profile has finished, and is drive_dist_timeout without a
+	// drive feedforward.
+	inline void drive_dist_profiled_timeout(double cm, unsigned long timeout, double error_threshold = 2, unsigned long required_time = 100, double max_velocity = PROFILE_VELOCITY, double max_acceleration = PROFILE_ACCELERATION, double max_jerk = PROFILE_JERK) {
+		if (controllers->drive_feedforward == nullptr) {
+			LOG("[Profile] No drive feedforward, driving on the PID\n");
+			drive_dist_timeout(cm, timeout, error_threshold, required_time);
+			return;
+		}
+		LOG("[Profile] Driving " << cm << " cm\n");
+
+		Profile profile(cm, max_velocity, max_acceleration, max_jerk);
+		double straight = controllers->odom->heading();
+		double offset = controllers->odom->forward();
+		controllers->drive->target(0);
+		unsigned long interval = controllers->drive->get_interval();
+
+		bool settling = false;
+		unsigned long settled_time = 0;
+		unsigned long start_time = pros::millis();
+
+		while (true) {
+			unsigned long elapsed = pros::millis() - start_time;
+			auto goal = profile.sample(elapsed / 1000.0);
+			double dist = controllers->odom->forward() - offset;
+
+			bool finished = elapsed >= profile.duration() * 1000;
+			bool close = std::abs(cm - dist) < error_threshold;
+			if (!settling && finished && close) {
+				settled_time = pros::millis();
+				settling = true;
+			}
+
+			if (settling) {
+				if (close) {
+					if (pros::millis() - settled_time > required_time) {
+						break;
+					}
+				} else {
+					settling = false;
+				}
+			}
+
+			if (elapsed > timeout || cancelling) {
+				break;
+			}
+
+			double drift = constrain_angle_180(controllers->odom->heading() - straight);
+			double power = std::clamp(controllers->drive_feedforward->calculate(goal.velocity, goal.acceleration)
+				+ controllers->drive->step(dist - goal.position), -12000.0, 12000.0);
+			double turn = controllers->angle->step(drift);
+
+			chassis->move_voltage(power, turn);
+			pros::delay(interval);
+		}
+
+		chassis->stop();
+		LOG("[Profile] Finished movement at " << (cm - controllers->odom->forward() + offset) << " cm error.\n");
+	}
+
+	inline void drive_dist_profiled(double cm, double error_threshold = 2, unsigned long required_time = 100, double max_velocity = PROFILE_VELOCITY, double max_acceleration = PROFILE_ACCELERATION, double max_jerk = PROFILE_JERK) {
+		drive_dist_profiled_timeout(cm, LONG_MAX, error_threshold, required_time, max_velocity, max_acceleration, max_jerk);
+	}
+
+	// Turns degrees in place, chained like drive_dist_timeout when given an
+	// exit_radius in degrees.
+	inline void turn_angle_timeout(double degrees, unsigned long timeout, double error_threshold = 2, unsigned long required_time = 100, double exit_radius = 0, double exit_speed = 0) {
         LOG("[PID] Turning " << degrees << " degrees\n");
 
         double offset = controllers->odom->raw_heading();
         controllers->turn->target(degrees);
 
         unsigned long interval = controllers->turn->get_interval();
+		double voltage = 0;
         
         bool settling_err = false;
         unsigned long err_time = 0;
 		unsigned long start_time = pros::millis();
 
         while (true) {
+			if (exit_radius > 0 && std::abs(controllers->turn->get_error()) < exit_radius) {
+				carry_drive = 0;
+				carry_turn = voltage;
+				carry_time = pros::millis();
+				LOG("[PID] Passed through at " << controllers->turn->get_error() << " degrees error.\n\n");
+				return;
+			}
 
             if (!settling_err && std::abs(controllers->turn->get_error()) < error_threshold) {
                 err_time = pros::millis();
@@ -738,14 +2821,19 @@ public:
 
 			unsigned long current_time = pros::millis();
 			auto time_diff = current_time - start_time;
-			if (time_diff > timeout) {
+			if (time_diff > timeout || cancelling) {
 				break;
 			} else if (timeout != LONG_MAX) {
 				//std::cout << "time diff: " << time_diff << ", timeout: " << timeout << "\n";
 			}
 
             double turn = controllers->odom->raw_heading() - offset;
-            double voltage = controllers->turn->step(turn);
+            voltage = controllers->turn->step(turn);
+
+			if (exit_radius > 0 && std::abs(voltage) < exit_speed) {
+				voltage = std::copysign(exit_speed, controllers->turn->get_error());
+			}
+			voltage = carry_over(voltage, carry_turn);
 
 			//std::cout << controllers->turn->get_setpoint() << "," << controllers->turn->get_reading() << "\n";
 
@@ -757,6 +2845,103 @@ public:
         LOG("[PID] Finished movement at " << controllers->turn->get_error() << " degrees error.\n\n");
     }
 
+	// Limits for turn_to_angle_profiled in deg/s, deg/s^2 and deg/s^3, kept
+	// under what the turn feedforward says 12 V can do, and the mV of
+	// correction per degree the robot lags the profile and per deg/s it
+	// turns slower than it.
+	static constexpr double TURN_VELOCITY = 480;
+	static constexpr double TURN_ACCELERATION = 2000;
+	static constexpr double TURN_JERK = 20000;
+	static constexpr double TURN_TRACK_P = 250;
+	static constexpr double TURN_TRACK_D = 15;
+
+	// Turns to a heading along a motion profile: the turn feedforward follows
+	// the profile and a PD on how far the robot is behind it corrects the
+	// rest, then the turn PID squares it up as turn_angle would. The profile
+	// starts from however fast the robot is already turning. With fastest
+	// set it also prices going the long way round and takes that when a turn
+	// already under way makes it quicker. Without a turn feedforward it is
+	// turn_to_angle_timeout.
+	inline void turn_to_angle_profiled_timeout(double degrees, unsigned long timeout, bool fastest = false, double error_threshold = 2, unsigned long required_time = 100, double max_velocity = TURN_VELOCITY, double max_acceleration = TURN_ACCELERATION, double max_jerk = TURN_JERK) {
+		if (controllers->turn_feedforward == nullptr) {
+			LOG("[Profile] No turn feedforward, turning on the PID\n");
+			turn_to_angle_timeout(degrees, timeout, error_threshold, required_time);
+			return;
+		}
+		double rate = controllers->odom->turn_rate();
+		double diff = constrain_angle_180(degrees - controllers->odom->heading());
+		Profile profile(diff, max_velocity, max_acceleration, max_jerk, rate);
+		if (fastest && diff != 0) {
+			Profile around(diff - std::copysign(360.0, diff), max_velocity, max_acceleration, max_jerk, rate);
+			if (around.duration() < profile.duration()) {
+				diff -= std::copysign(360.0, diff);
+				profile = around;
+			}
+		}
+		LOG("[Profile] Turning " << diff << " degrees to " << degrees << "\n");
+
+		double offset = controllers->odom->raw_heading();
+		unsigned long interval = controllers->turn->get_interval();
+		bool holding = false;
+
+		bool settling = false;
+		unsigned long settled_time = 0;
+		unsigned long start_time = pros::millis();
+
+		while (true) {
+			unsigned long elapsed = pros::millis() - start_time;
+			auto goal = profile.sample(elapsed / 1000.0);
+			double turned = controllers->odom->raw_heading() - offset;
+
+			bool finished = elapsed >= profile.duration() * 1000;
+			bool close = finished && std::abs(diff - turned) < error_threshold;
+			if (!settling && close) {
+				settled_time = pros::millis();
+				settling = true;
+			}
+
+			if (settling) {
+				if (close) {
+					if (pros::millis() - settled_time > required_time) {
+						break;
+					}
+				} else {
+					settling = false;
+				}
+			}
+
+			if (elapsed > timeout || cancelling) {
+				break;
+			}
+
+			double voltage;
+			if (finished) {
+				// Too little is left for the profile's gains to move the robot
+				// through the scrub, so the turn PID squares it up.
+				if (!holding) {
+					controllers->turn->target(diff);
+					holding = true;
+				}
+				voltage = controllers->turn->step(turned);
+			} else {
+				double lag = goal.position - turned;
+				double slow = goal.velocity - controllers->odom->turn_rate();
+				voltage = controllers->turn_feedforward->calculate(goal.velocity * DEGREE_TO_RADIAN, goal.acceleration * DEGREE_TO_RADIAN)
+					+ TURN_TRACK_P * lag + TURN_TRACK_D * slow;
+			}
+
+			chassis->turn_voltage(std::clamp(voltage, -12000.0, 12000.0));
+			pros::delay(interval);
+		}
+
+		chassis->stop();
+		LOG("[Profile] Finished movement at " << (diff - controllers->odom->raw_heading() + offset) << " degrees error.\n\n");
+	}
+
+	inline void turn_to_angle_profiled(double degrees, bool fastest = false, double error_threshold = 2, unsigned long required_time = 100, double max_velocity = TURN_VELOCITY, double max_acceleration = TURN_ACCELERATION, double max_jerk = TURN_JERK) {
+		turn_to_angle_profiled_timeout(degrees, LONG_MAX, fastest, error_threshold, required_time, max_velocity, max_acceleration, max_jerk);
+	}
+
 	inline void turn_angle(double degrees, double error_threshold = 2, unsigned long required_time = 250) {
         turn_angle_timeout(degrees, LONG_MAX, error_threshold, required_time);
     }
@@ -772,6 +2957,12 @@ public:
 		turn_angle_timeout(diff, ms, error_threshold, required_time);
 	}
 
+	inline void turn_to_angle_chained(double degrees, double exit_radius = 5, double exit_speed = 2500) {
+		double diff = constrain_angle_180(degrees - controllers->odom->heading());
+		LOG("[PID] Turning to angle " << degrees << "\n");
+		turn_angle_timeout(diff, LONG_MAX, 2, 0, exit_radius, exit_speed);
+	}
+
 	inline void turn_to_point(double x, double y, bool reverse = false) {
 		double angle = calc_angle_to_point(x, y, reverse);
 		LOG("[Odom] Turning to point (" << x << ", " << y << ")\n");
@@ -781,19 +2972,495 @@ public:
 
 	inline void drive_to_point(double x, double y, bool reverse = false) {
 		LOG("[Odom] Beginning movement to point (" << x << ", " << y << ")\n");
+		// Coming out of a chained motion the robot coasts on through the
+		// turn, so aim again from wherever it ends up.
+		bool moving = carrying();
 		turn_to_point(x, y, reverse);
+		if (moving) {
+			turn_to_point(x, y, reverse);
+		}
 		double dist = calc_dist_to_point(x, y, reverse);
 		LOG("[Odom] Driving to point (" << x << ", " << y << ")\n");
 		LOG("[Odom] Calculated dist " << dist << " cm to point\n");
 		drive_dist(dist);
 	}
 
+	// A waypoint the robot drives through on the way to the next one: the
+	// turn ends once it is within a few degrees and the drive chains on.
+	inline void drive_to_point_chained(double x, double y, bool reverse = false, double exit_radius = 5, double exit_speed = 3000) {
+		LOG("[Odom] Beginning movement through point (" << x << ", " << y << ")\n");
+		bool moving = carrying();
+		turn_to_angle_timeout(calc_angle_to_point(x, y, reverse), LONG_MAX, 2, 0);
+		if (moving) {
+			turn_to_angle_timeout(calc_angle_to_point(x, y, reverse), LONG_MAX, 2, 0);
+		}
+		drive_dist_chained(calc_dist_to_point(x, y, reverse), exit_radius, exit_speed);
+	}
+
 	inline void drive_to_point_noturn(double x, double y, bool reverse = false) {
 		double dist = calc_dist_to_point(x, y, reverse);
 		LOG("[Odom] Driving to point (" << x << ", " << y << ")\n");
 		LOG("[Odom] Calculated dist " << dist << " cm to point\n");
 		drive_dist(dist);
 	}
+
+	// Lookahead for follow_path grows with speed, in cm and cm per cm/s.
+	static constexpr double LOOKAHEAD_MIN = 15;
+	static constexpr double LOOKAHEAD_MAX = 35;
+	static constexpr double LOOKAHEAD_GAIN = 0.15;
+	// Radius in cm at which follow_path is down to half power in a curve.
+	static constexpr double CURVE_RADIUS = 40;
+	// Within this many cm of the last waypoint follow_path stops steering.
+	static constexpr double HOLD_RADIUS = 5;
+
+	// Pure pursuit through the waypoints without stopping at them. The robot
+	// steers for the point one lookahead further along the path than where it
+	// is, slowing in tight curves. The drive PID runs on the distance along the
+	// path, and the move settles the way drive_dist_timeout does.
+	inline void follow_path_timeout(const std::vector<Waypoint>& path, unsigned long timeout, bool reverse = false, double error_threshold = 2, unsigned long required_time = 250) {
+		LOG("[Pursuit] Following " << path.size() << " waypoints\n");
+
+		auto start = controllers->odom->position();
+		std::vector<Waypoint> points = {{start.x, start.y}};
+		for (auto& point : path) {
+			if (std::hypot(point.x - points.back().x, point.y - points.back().y) > 1e-6) {
+				points.push_back(point);
+			}
+		}
+		if (points.size() < 2) {
+			return;
+		}
+
+		// Distance along the path to each waypoint.
+		std::vector<double> along = {0};
+		for (std::size_t i = 1; i < points.size(); i++) {
+			along.push_back(along.back() + std::hypot(points[i].x - points[i - 1].x, points[i].y - points[i - 1].y));
+		}
+
+		controllers->drive->target(along.back());
+		unsigned long interval = controllers->drive->get_interval();
+
+		std::size_t segment = 0;
+		double prev_x = start.x;
+		double prev_y = start.y;
+
+		bool settling = false;
+		unsigned long settled_time = 0;
+		unsigned long start_time = pros::millis();
+
+		while (true) {
+			if (!settling && std::abs(controllers->drive->get_error()) < error_threshold) {
+				settled_time = pros::millis();
+				settling = true;
+			}
+
+			if (settling) {
+				if (std::abs(controllers->drive->get_error()) < error_threshold) {
+					if (pros::millis() - settled_time > required_time) {
+						break;
+					}
+				} else {
+					settling = false;
+				}
+			}
+
+			if (pros::millis() - start_time > timeout || cancelling) {
+				break;
+			}
+
+			auto pose = controllers->odom->position();
+
+			// Where the robot is along the path, moving on a segment once it
+			// passes the end of one.
+			double travelled = 0;
+			while (true) {
+				auto& a = points[segment];
+				auto& b = points[segment + 1];
+				double length = along[segment + 1] - along[segment];
+				double t = ((pose.x - a.x) * (b.x - a.x) + (pose.y - a.y) * (b.y - a.y)) / (length * length);
+				if (t > 1 && segment + 2 < points.size()) {
+					segment++;
+					continue;
+				}
+				travelled = along[segment] + std::max(t, segment == 0 ? -INFINITY : 0.0) * length;
+				break;
+			}
+
+			double speed = std::hypot(pose.x - prev_x, pose.y - prev_y) / (interval / 1000.0);
+			prev_x = pose.x;
+			prev_y = pose.y;
+			double lookahead = std::clamp(LOOKAHEAD_MIN + LOOKAHEAD_GAIN * speed, LOOKAHEAD_MIN, LOOKAHEAD_MAX);
+
+			// The carrot, one lookahead on along the path. Within a lookahead of
+			// the end the robot homes on the last waypoint instead, reading its
+			// distance to it, so it closes any offset from the final segment.
+			double target = travelled + lookahead;
+			double goal_x = points.back().x;
+			double goal_y = points.back().y;
+			if (target < along.back()) {
+				std::size_t carrot = segment;
+				while (along[carrot + 1] < target) {
+					carrot++;
+				}
+				auto& a = points[carrot];
+				auto& b = points[carrot + 1];
+				double t = (target - along[carrot]) / (along[carrot + 1] - along[carrot]);
+				goal_x = a.x + (b.x - a.x) * t;
+				goal_y = a.y + (b.y - a.y) * t;
+			}
+
+			double facing = pose.theta + (reverse ? M_PI : 0);
+			double dx = goal_x - pose.x;
+			double dy = goal_y - pose.y;
+			double ahead = dx * std::cos(facing) + dy * std::sin(facing);
+			double aside = dy * std::cos(facing) - dx * std::sin(facing);
+			double distance = ahead * ahead + aside * aside;
+			// Too close to the last waypoint to steer for it without spinning, so
+			// the robot just drives straight to come level with it.
+			bool holding = distance < HOLD_RADIUS * HOLD_RADIUS;
+			double curvature = holding ? 0 : 2 * aside / distance;
+			bool homing = target >= along.back();
+			if (homing) {
+				travelled = along.back() - (holding ? ahead : std::copysign(std::sqrt(distance), ahead));
+			}
+
+			double power = controllers->drive->step(travelled);
+			if (!homing) {
+				power /= 1 + CURVE_RADIUS * std::abs(curvature);
+			}
+			chassis->move_curvature(reverse ? -power : power, reverse ? -curvature : curvature);
+			pros::delay(interval);
+		}
+
+		chassis->stop();
+		LOG("[Pursuit] Finished path at " << controllers->drive->get_error() << " cm error.\n");
+	}
+
+	inline void follow_path(const std::vector<Waypoint>& path, bool reverse = false, double error_threshold = 2, unsigned long required_time = 250) {
+		follow_path_timeout(path, LONG_MAX, reverse, error_threshold, required_time);
+	}
+
+	// How far behind the target the boomerang carrot starts, as a share of
+	// the distance left; mV of turn per degree the robot faces off it and per
+	// degree per second it is already turning; and the cm from the target
+	// inside which it squares up to the heading instead.
+	static constexpr double BOOMERANG_LEAD = 0.6;
+	static constexpr double BOOMERANG_TURN = 500;
+	static constexpr double BOOMERANG_DAMPING = 30;
+	static constexpr double BOOMERANG_SETTLE = 10;
+
+	// Drives to a point and arrives facing heading, in degrees like
+	// turn_to_angle. The robot turns toward a carrot set back from the target
+	// along the heading by a share of the distance left, so it curves in on
+	// the heading as the carrot closes on the target. Over the last few cm the
+	// turn PID squares it up to the heading as turn_to_angle would. The drive
+	// PID runs on the distance left, and the move settles the way
+	// drive_dist_timeout does.
+	inline void move_to_pose_timeout(double x, double y, double heading, unsigned long timeout, bool reverse = false, double error_threshold = 2, unsigned long required_time = 250) {
+		LOG("[Boomerang] Moving to " << x << ", " << y << " facing " << heading << " degrees\n");
+
+		auto start = controllers->odom->position();
+		double total = std::hypot(x - start.x, y - start.y);
+		controllers->drive->target(total);
+		unsigned long interval = controllers->drive->get_interval();
+
+		// The way the robot travels as it arrives.
+		double arrival = heading * DEGREE_TO_RADIAN + (reverse ? M_PI : 0);
+		double prev_theta = start.theta;
+		bool squaring = false;
+		double offset = 0;
+
+		bool settling = false;
+		unsigned long settled_time = 0;
+		unsigned long start_time = pros::millis();
+
+		while (true) {
+			bool arrived = squaring && std::abs(controllers->drive->get_error()) < error_threshold;
+			if (!settling && arrived) {
+				settled_time = pros::millis();
+				settling = true;
+			}
+
+			if (settling) {
+				if (arrived) {
+					if (pros::millis() - settled_time > required_time) {
+						break;
+					}
+				} else {
+					settling = false;
+				}
+			}
+
+			if (pros::millis() - start_time > timeout || cancelling) {
+				break;
+			}
+
+			auto pose = controllers->odom->position();
+			double facing = pose.theta + (reverse ? M_PI : 0);
+			double remaining = std::hypot(x - pose.x, y - pose.y);
+			double along = (x - pose.x) * std::cos(facing) + (y - pose.y) * std::sin(facing);
+			double rate = std::remainder(pose.theta - prev_theta, 2 * M_PI) / (interval / 1000.0);
+			prev_theta = pose.theta;
+
+			if (!squaring && remaining < BOOMERANG_SETTLE) {
+				squaring = true;
+				offset = controllers->odom->raw_heading();
+				controllers->turn->target(constrain_angle_180(heading - controllers->odom->heading()));
+			}
+
+			double off;
+			double turn;
+			double power;
+			if (squaring) {
+				off = std::remainder(arrival - facing, 2 * M_PI);
+				turn = controllers->turn->step(controllers->odom->raw_heading() - offset);
+				power = controllers->drive->step(total - along);
+			} else {
+				double carrot_x = x - remaining * BOOMERANG_LEAD * std::cos(arrival);
+				double carrot_y = y - remaining * BOOMERANG_LEAD * std::sin(arrival);
+				off = std::remainder(std::atan2(carrot_y - pose.y, carrot_x - pose.x) - facing, 2 * M_PI);
+				turn = (BOOMERANG_TURN * off - BOOMERANG_DAMPING * rate) * RADIAN_TO_DEGREE;
+				power = controllers->drive->step(total - remaining);
+			}
+
+			// Slow down while facing away from where the robot is going, and
+			// leave the turn the headroom it needs.
+			double headroom = std::max(0.0, 12000 - std::abs(turn));
+			power = std::clamp(power * std::cos(off), -headroom, headroom);
+			chassis->move_voltage(reverse ? -power : power, turn);
+			pros::delay(interval);
+		}
+
+		chassis->stop();
+		LOG("[Boomerang] Finished move at " << controllers->drive->get_error() << " cm error.\n");
+	}
+
+	inline void move_to_pose(double x, double y, double heading, bool reverse = false, double error_threshold = 2, unsigned long required_time = 250) {
+		move_to_pose_timeout(x, y, heading, LONG_MAX, reverse, error_threshold, required_time);
+	}
+
+	// Limits for generate_trajectory in cm/s, cm/s^2 and cm/s^3, and the time
+	// step of the profile it returns in seconds.
+	static constexpr double TRAJECTORY_VELOCITY = 130;
+	static constexpr double TRAJECTORY_ACCELERATION = 250;
+	static constexpr double TRAJECTORY_JERK = 2000;
+	static constexpr double TRAJECTORY_STEP = 0.01;
+	// RAMSETE gains: b in rad^2/cm^2 (5 rad^2/m^2) and the damping ratio.
+	static constexpr double RAMSETE_B = 5e-4;
+	static constexpr double RAMSETE_ZETA = 0.7;
+
+	// A smooth profile through the poses, in cm and radians in Odom's frame,
+	// first pose where the robot starts. With reverse the yaws are the way
+	// the robot faces and it drives the path backwards.
+	inline std::vector<squiggles::ProfilePoint> generate_trajectory(std::vector<squiggles::Pose> waypoints, bool reverse = false, double max_velocity = TRAJECTORY_VELOCITY, double max_acceleration = TRAJECTORY_ACCELERATION) {
+		if (reverse) {
+			for (auto& pose : waypoints) {
+				pose.yaw += M_PI;
+			}
+		}
+		squiggles::Constraints limits(max_velocity, max_acceleration, TRAJECTORY_JERK);
+		squiggles::SplineGenerator generator(limits, std::make_shared<squiggles::TankModel>(chassis->get_track_width(), limits), TRAJECTORY_STEP);
+		return generator.generate(waypoints);
+	}
+
+	// Tracks a profile in time with RAMSETE on the Odom pose. Returns when the
+	// profile runs out, so it needs no settle.
+	inline void follow_trajectory_timeout(const std::vector<squiggles::ProfilePoint>& trajectory, unsigned long timeout, bool reverse = false) {
+		if (trajectory.empty() || controllers->drive_feedforward == nullptr || controllers->turn_feedforward == nullptr) {
+			LOG("[Ramsete] Needs a trajectory and both feedforwards\n");
+			return;
+		}
+		LOG("[Ramsete] Following " << trajectory.back().time << " s trajectory\n");
+
+		unsigned long interval = controllers->drive->get_interval();
+		std::size_t index = 0;
+		unsigned long start_time = pros::millis();
+
+		while (pros::millis() - start_time <= timeout && !cancelling) {
+			double elapsed = (pros::millis() - start_time) / 1000.0;
+			while (index + 1 < trajectory.size() && trajectory[index + 1].time <= elapsed) {
+				index++;
+			}
+			auto& point = trajectory[index];
+			auto& next = trajectory[std::min(index + 1, trajectory.size() - 1)];
+
+			double angular = point.vector.vel * point.curvature;
+			double step = next.time - point.time;
+			double angular_acceleration = step > 0 ? (next.vector.vel * next.curvature - angular) / step : 0;
+			ramsete_step(point.vector.pose.x, point.vector.pose.y, point.vector.pose.yaw, point.vector.vel,
+			             point.vector.accel, angular, angular_acceleration, reverse);
+
+			if (elapsed >= trajectory.back().time) {
+				break;
+			}
+			pros::delay(interval);
+		}
+
+		chassis->stop();
+		LOG("[Ramsete] Finished trajectory\n");
+	}
+
+	// The same for a precompiled table, reading it in place without
+	// allocating.
+	inline void follow_trajectory_timeout(const Trajectory& trajectory, unsigned long timeout) {
+		if (trajectory.size == 0 || controllers->drive_feedforward == nullptr || controllers->turn_feedforward == nullptr) {
+			LOG("[Ramsete] Needs a trajectory and both feedforwards\n");
+			return;
+		}
+		LOG("[Ramsete] Following " << (trajectory.size - 1) * trajectory.step << " s table\n");
+
+		unsigned long interval = controllers->drive->get_interval();
+		double duration = (trajectory.size - 1) * trajectory.step;
+		unsigned long start_time = pros::millis();
+
+		while (pros::millis() - start_time <= timeout && !cancelling) {
+			double elapsed = (pros::millis() - start_time) / 1000.0;
+			std::size_t index = std::min(static_cast<std::size_t>(elapsed / trajectory.step), trajectory.size - 1);
+			auto& point = trajectory.points[index];
+			auto& next = trajectory.points[std::min(index + 1, trajectory.size - 1)];
+
+			double velocity = point.velocity / TrajectoryPoint::VELOCITY;
+			double angular = velocity * point.curvature / TrajectoryPoint::CURVATURE;
+			double next_angular = next.velocity / TrajectoryPoint::VELOCITY * next.curvature / TrajectoryPoint::CURVATURE;
+			ramsete_step(point.x / TrajectoryPoint::POSITION, point.y / TrajectoryPoint::POSITION,
+			             point.yaw / TrajectoryPoint::YAW, velocity, point.acceleration / TrajectoryPoint::ACCELERATION,
+			             angular, (next_angular - angular) / trajectory.step, trajectory.reverse);
+
+			if (elapsed >= duration) {
+				break;
+			}
+			pros::delay(interval);
+		}
+
+		chassis->stop();
+		LOG("[Ramsete] Finished table\n");
+	}
+
+	inline void follow_trajectory(const std::vector<squiggles::ProfilePoint>& trajectory, bool reverse = false) {
+		follow_trajectory_timeout(trajectory, LONG_MAX, reverse);
+	}
+
+	inline void follow_trajectory(const Trajectory& trajectory) {
+		follow_trajectory_timeout(trajectory, LONG_MAX);
+	}
+
+	// One step of closed-loop velocity control: linear cm/s and angular rad/s
+	// (positive turning the way turn_angle does) become a speed for each
+	// tracking wheel, which the side's VelocityController holds. Call it
+	// every few ms from a loop, or use hold_velocity.
+	inline void track_velocity(double linear, double angular, double linear_acceleration = 0, double angular_acceleration = 0) {
+		if (controllers->left_velocity == nullptr || controllers->right_velocity == nullptr) {
+			LOG("[Velocity] Needs both velocity controllers\n");
+			return;
+		}
+		double half = controllers->odom->get_trackwidth() / 2;
+		unsigned long now = pros::millis();
+		unsigned long gap = now - velocity_time;
+		velocity_time = now;
+		// A long gap means a fresh start; the old integrals no longer apply.
+		if (gap > 100) {
+			controllers->left_velocity->reset();
+			controllers->right_velocity->reset();
+		}
+		double dt = std::clamp(gap, 1ul, 100ul) / 1000.0;
+
+		double left = controllers->left_velocity->step(linear + angular * half, linear_acceleration + angular_acceleration * half,
+		                                               controllers->odom->left_velocity(), dt);
+		double right = controllers->right_velocity->step(linear - angular * half, linear_acceleration - angular_acceleration * half,
+		                                                 controllers->odom->right_velocity(), dt);
+		chassis->move_tank(left, right);
+	}
+
+	// Has the chassis task hold these speeds until hold_velocity is called
+	// again, a motion is queued or cancel() runs. For driver assist.
+	inline void hold_velocity(double linear, double angular) {
+		if (controllers->left_velocity == nullptr || controllers->right_velocity == nullptr) {
+			LOG("[Velocity] Needs both velocity controllers\n");
+			return;
+		}
+		hold_linear = linear;
+		hold_angular = angular;
+		holding = true;
+	}
+
+	// Runs for fitting the drive feedforward: a slow voltage ramp of ramp
+	// mV/s each way, where acceleration is negligible, then a step of step mV
+	// each way, which is mostly acceleration. Each run stops once the
+	// tracking wheels have rolled distance cm on average and the next goes
+	// back over the same ground. Straight runs fit each side's voltage
+	// against cm/s; with spin the sides run opposite voltages in place and
+	// the fit is of that voltage against the tracking wheels' turn rate in
+	// rad/s. Returns the least-squares fit, or nullptr if the runs did not
+	// move. With log set it also logs every sample, as drive or spin then
+	// ms, mV, speed and acceleration, for sim/fit_drive.py to refit.
+	inline std::unique_ptr<Feedforward> characterize(bool spin = false, double distance = 120, double ramp = 1000, double step = 6000, unsigned long interval = 10, bool log = false) {
+		auto& odom = controllers->odom;
+		auto speed = [&] {
+			return spin ? odom->turn_rate(true) : (odom->left_velocity() + odom->right_velocity()) / 2;
+		};
+		std::vector<Feedforward::Sample> samples;
+		auto run = [&](double direction, bool stepped) {
+			double start_left = odom->left_position();
+			double start_right = odom->right_position();
+			double prev = speed();
+			unsigned long start_time = pros::millis();
+			while (std::abs(odom->left_position() - start_left) + std::abs(odom->right_position() - start_right) < 2 * distance && !cancelling) {
+				double elapsed = (pros::millis() - start_time) / 1000.0;
+				double voltage = direction * std::min(stepped ? step : ramp * elapsed, 12000.0);
+				chassis->move_tank(voltage, spin ? -voltage : voltage);
+				pros::delay(interval);
+
+				double velocity = speed();
+				samples.push_back({voltage, velocity, (velocity - prev) / (interval / 1000.0)});
+				if (log) {
+					LOG("[Characterize] " << (spin ? "spin," : "drive,") << pros::millis() << "," << voltage << "," << velocity << ","
+					    << samples.back().acceleration << "\n");
+				}
+				prev = velocity;
+			}
+			chassis->stop();
+			pros::delay(1000);
+		};
+		run(1, false);
+		run(-1, false);
+		run(1, true);
+		run(-1, true);
+
+		// Below these the robot is as good as still either way.
+		auto fit = Feedforward::fit(samples, 0, spin ? 0.02 : 1);
+		if (fit) {
+			const char* units = spin ? "rad/s" : "cm/s";
+			LOG("[Characterize] ks " << fit->get_ks() << " mV, kv " << fit->get_kv() << " mV per " << units << ", ka "
+			    << fit->get_ka() << " mV per " << units << "/s\n");
+		}
+		return fit;
+	}
+
+	// The motions autons use most, queued through async().
+	inline Motion drive_dist_async(double cm, double error_threshold = 2, unsigned long required_time = 100) {
+		return async([=] { drive_dist(cm, error_threshold, required_time); });
+	}
+
+	inline Motion turn_to_angle_async(double degrees, double error_threshold = 2, unsigned long required_time = 250) {
+		return async([=] { turn_to_angle(degrees, error_threshold, required_time); });
+	}
+
+	inline Motion drive_to_point_async(double x, double y, bool reverse = false) {
+		return async([=] { drive_to_point(x, y, reverse); });
+	}
+
+	inline Motion follow_path_async(std::vector<Waypoint> path, bool reverse = false) {
+		return async([=] { follow_path(path, reverse); });
+	}
+
+	inline Motion move_to_pose_async(double x, double y, double heading, bool reverse = false) {
+		return async([=] { move_to_pose(x, y, heading, reverse); });
+	}
+
+	inline Motion follow_trajectory_async(const Trajectory& trajectory) {
+		return async([=] { follow_trajectory(trajectory); });
+	}
+
 	inline static std::unique_ptr<Robot> create(
 		std::unique_ptr<Chassis> ichassis, 
 		std::unique_ptr<Controllers> icontrollers, 
@@ -801,7 +3468,8 @@ public:
 		std::unique_ptr<Flywheel> iflywheel,
 		std::unique_ptr<Indexer> iindexer,
 		std::unique_ptr<Anglechg> ianglechg,
-		std::unique_ptr<Endgame> iendgame) {
+		std::unique_ptr<Endgame> iendgame,
+		std::unique_ptr<ShotMap> ishot_map = nullptr) {
 		
 		return std::make_unique<Robot>(
 			std::move(ichassis), 
@@ -810,7 +3478,8 @@ public:
 			std::move(iflywheel),
 			std::move(iindexer),
 			std::move(ianglechg),
-			std::move(iendgame)
+			std::move(iendgame),
+			std::move(ishot_map)
 		);
 	}
 };
@@ -0,0 +1,20 @@
+#include "robot.hpp"
+#include <cstdio>
+
+// Runs auto_characterize on the simulated robot, so the constants it prints
+// can be checked against the ones the model was built with.
+
+int main() {
+	sim::World world;
+	sim::hbot_world(world);
+	bool finished = world.run([&] {
+		initialize();
+		auto_characterize();
+	}, 120000);
+	std::fflush(stdout);
+	if (!finished) {
+		std::fprintf(stderr, "auto_characterize did not finish\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,184 @@
+#pragma once
+#include "sim.hpp"
+#include <cmath>
+#include <vector>
+
+namespace sim {
+
+struct Pose {
+	double x = 0;      // cm
+	double y = 0;      // cm
+	double theta = 0;  // radians, clockwise positive like Odom
+};
+
+struct DriveConfig {
+	// Signed ports exactly as passed to Chassis::create.
+	std::vector<std::int8_t> left;
+	std::vector<std::int8_t> right;
+	pros::motor_gearset_e_t cartridge = pros::E_MOTOR_GEARSET_06;
+	double gear_ratio = 36.0 / 48.0;            // wheel turns per motor turn
+	double wheel_diameter = 3.25 * 2.54;        // cm
+	double drive_width = 11.5 * 2.54;           // cm between wheel contact lines
+
+	// Tracking wheels as passed to Odom::create. A mount of -1 means the sensor
+	// turns backwards when its wheel rolls forward.
+	std::uint8_t left_sensor = 0;
+	std::uint8_t right_sensor = 0;
+	double left_mount = 1;
+	double right_mount = -1;
+	double tracking_diameter = 2.75 * 2.54;     // cm
+	double tracking_width = 5.25 * 2.54;        // cm
+
+	// Optional third tracking wheel across the others, back_offset cm behind
+	// the centre; a mount of 1 reads positive as the robot slides right.
+	std::uint8_t back_sensor = 0;
+	double back_mount = 1;
+	double back_offset = 0;
+
+	// Inertial sensor on the chassis, 0 for none.
+	std::uint8_t imu = 0;
+
+	double mass = 6.5;                          // kg
+	double inertia = 0.13;                      // kg*m^2 about the centre
+
+	double wheel_mass = 1.5;                    // kg, gearbox inertia seen at one side's tread
+	double traction = 1.0;                      // tyre friction coefficient
+	double slip_stiffness = 400;                // N per m/s of tread slip before breaking loose
+	double lateral_stiffness = 2000;            // N per m/s of sideways slip before breaking loose
+	double rolling_resistance = 0.03;           // fraction of a side's normal load
+	double viscous_drag = 1.5;                  // N per m/s of tread speed, per side
+	double scrub = 0.02;                        // m, lever arm of the skid-steer scrub torque
+};
+
+// Tank drive with the world's motor curve on each side, tyre traction and
+// slip, rolling and gearbox losses and turning scrub. The tracking wheels
+// follow the chassis, so they see slip the way the real ones do.
+class Drivetrain : public Plant {
+public:
+	static constexpr double GRAVITY = 9.81;
+
+	DriveConfig config;
+	Pose pose;
+	double velocity = 0;          // m/s forward
+	double lateral_velocity = 0;  // m/s to the right
+	double angular_velocity = 0;  // rad/s clockwise
+	double left_tread = 0;        // m/s surface speed of the left wheels
+	double right_tread = 0;       // m/s surface speed of the right wheels
+
+	// Disturbances a scenario can switch on, such as a collision that spins
+	// the robot while the tracking wheels bounce off the ground.
+	double external_torque = 0;   // N*m clockwise about the centre
+	double external_force = 0;    // N pushing the robot to its right
+	bool tracking_contact = true;
+
+	Drivetrain(World& world, DriveConfig iconfig) : config(std::move(iconfig)) {
+		for (auto port : config.left) {
+			claim(world, port);
+		}
+		for (auto port : config.right) {
+			claim(world, port);
+		}
+		if (config.imu != 0) {
+			world.imu(config.imu).present = true;
+		}
+	}
+
+	void step(World& world, double dt) override {
+		double half_width = config.drive_width / 200.0;
+		double load = config.mass * GRAVITY / 2;
+
+		double left_ground = velocity + angular_velocity * half_width;
+		double right_ground = velocity - angular_velocity * half_width;
+
+		double left_grip = grip(left_tread - left_ground, load);
+		double right_grip = grip(right_tread - right_ground, load);
+
+		left_tread += (motor_force(world, config.left, left_tread, dt) - left_grip - losses(left_tread, load)) /
+		              config.wheel_mass * dt;
+		right_tread += (motor_force(world, config.right, right_tread, dt) - right_grip - losses(right_tread, load)) /
+		               config.wheel_mass * dt;
+
+		double scrub = config.scrub * config.mass * GRAVITY * std::tanh(angular_velocity / 0.05);
+		double side_grip = grip(lateral_velocity, 2 * load, config.lateral_stiffness);
+
+		// Body frame, so turning trades forward and sideways speed.
+		double accel = (left_grip + right_grip) / config.mass + angular_velocity * lateral_velocity;
+		double lateral_accel = (external_force - side_grip) / config.mass - angular_velocity * velocity;
+		double angular_accel = ((left_grip - right_grip) * half_width - scrub + external_torque) / config.inertia;
+
+		integrate(world, accel, lateral_accel, angular_accel, dt);
+	}
+
+protected:
+	void claim(World& world, std::int8_t port) {
+		auto& motor = world.motor(port);
+		motor.claimed = true;
+		motor.cartridge = config.cartridge;
+	}
+
+	// Spins every motor on one side at the shaft speed implied by the tread
+	// speed and returns their summed force at the tread in newtons.
+	double motor_force(World& world, const std::vector<std::int8_t>& ports, double tread, double dt) {
+		double radius = config.wheel_diameter / 200.0;
+		double shaft_rpm = tread / radius / config.gear_ratio * 60.0 / (2 * M_PI);
+		double torque = 0;
+
+		for (auto port : ports) {
+			double mount = port < 0 ? -1.0 : 1.0;
+			auto& motor = world.motor(port);
+			motor.velocity = mount * shaft_rpm;
+			motor.position += motor.velocity * 6 * dt;
+			motor.torque = motor.torque_at(motor.velocity);
+			torque += mount * motor.torque;
+		}
+
+		return torque / config.gear_ratio / radius;
+	}
+
+	// Traction force from tread slip, saturating at the friction limit.
+	double grip(double slip, double load) const {
+		return grip(slip, load, config.slip_stiffness);
+	}
+
+	double grip(double slip, double load, double stiffness) const {
+		double limit = config.traction * load;
+		return limit * std::tanh(stiffness * slip / limit);
+	}
+
+	double losses(double tread, double load) const {
+		return config.rolling_resistance * load * std::tanh(tread / 0.02) + config.viscous_drag * tread;
+	}
+
+	void integrate(World& world, double accel, double lateral_accel, double angular_accel, double dt) {
+		velocity += accel * dt;
+		lateral_velocity += lateral_accel * dt;
+		angular_velocity += angular_accel * dt;
+
+		double dtheta = angular_velocity * dt;
+		double ds = velocity * dt * 100;
+		double dside = lateral_velocity * dt * 100;
+		double heading = pose.theta + dtheta / 2;
+		pose.x += ds * std::cos(heading) - dside * std::sin(heading);
+		pose.y += ds * std::sin(heading) + dside * std::cos(heading);
+		pose.theta += dtheta;
+
+		if (config.imu != 0) {
+			world.imu(config.imu).turn(dtheta * 180 / M_PI, dt);
+		}
+
+		if (tracking_contact) {
+			double half_track = config.tracking_width / 2;
+			roll(world, config.left_sensor, config.left_mount, ds + dtheta * half_track);
+			roll(world, config.right_sensor, config.right_mount, ds - dtheta * half_track);
+			roll(world, config.back_sensor, config.back_mount, dside - dtheta * config.back_offset);
+		}
+	}
+
+	void roll(World& world, std::uint8_t port, double mount, double distance) {
+		if (port != 0) {
+			world.rotation(port).angle += mount * distance / (config.tracking_diameter * M_PI) * 360.0;
+		}
+	}
+};
+
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include "drive.hpp"
+#include "random.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace sim {
+
+// Where the drivetrain's origin sits on the field, in the pros::Gps frame: cm
+// from the field centre, +y at heading 0, headings in degrees clockwise.
+struct Placement {
+	double x = 0;
+	double y = 0;
+	double heading = 0;
+};
+
+struct DistanceMount {
+	std::uint8_t port;
+	double forward;   // cm ahead of the drivetrain centre
+	double right;     // cm right of it
+	double angle;     // degrees clockwise from straight ahead
+};
+
+struct FieldConfig {
+	double size = 144 * 2.54;                   // cm between the walls
+	Placement start;
+	// Outlines of obstacles on the field, corners in order, cm.
+	std::vector<std::vector<std::pair<double, double>>> obstacles;
+
+	std::uint8_t gps = 0;                       // port, 0 for none
+	double gps_noise = 1.0;                     // cm, standard deviation of a fix
+	double gps_heading_noise = 0.5;             // degrees
+	double gps_outliers = 0;                    // share of fixes thrown 30-80 cm off
+
+	std::vector<DistanceMount> distances;
+	std::uint32_t distance_rate = 33;           // ms between readings
+	double distance_outliers = 0;               // share of readings cut short by something in the way
+};
+
+// Places the drivetrain on a walled field and feeds the GPS and distance
+// sensors from its true pose, with the noise of the real sensors: a GPS fix
+// wanders by gps_noise and reports about that as its error, and a distance
+// reading is good to 15 mm under 200 mm and 5% beyond, out to 2 m.
+class FieldSensors : public Plant {
+	const Drivetrain& drive;
+	Random random;
+	std::uint32_t elapsed = 0;
+
+public:
+	FieldConfig config;
+
+	FieldSensors(World& world, const Drivetrain& idrive, FieldConfig iconfig, std::uint64_t seed = 1) :
+	drive(idrive), random(seed), config(std::move(iconfig)) {
+		if (config.gps != 0) {
+			world.gps(config.gps).present = true;
+		}
+		for (auto& mount : config.distances) {
+			world.distance(mount.port).present = true;
+		}
+	}
+
+	// The drivetrain's true pose on the field.
+	inline Placement placement() const {
+		double heading = config.start.heading * M_PI / 180;
+		double s = std::sin(heading);
+		double c = std::cos(heading);
+		return {
+			config.start.x + drive.pose.x * s + drive.pose.y * c,
+			config.start.y + drive.pose.x * c - drive.pose.y * s,
+			config.start.heading + drive.pose.theta * 180 / M_PI,
+		};
+	}
+
+	// Distance to the nearest wall or obstacle from (x, y) along heading radians.
+	inline double wall(double x, double y, double heading) const {
+		double half = config.size / 2;
+		double dx = std::sin(heading);
+		double dy = std::cos(heading);
+		double range = INFINITY;
+		if (dx > 1e-9) {
+			range = std::min(range, (half - x) / dx);
+		} else if (dx < -1e-9) {
+			range = std::min(range, (-half - x) / dx);
+		}
+		if (dy > 1e-9) {
+			range = std::min(range, (half - y) / dy);
+		} else if (dy < -1e-9) {
+			range = std::min(range, (-half - y) / dy);
+		}
+
+		for (auto& outline : config.obstacles) {
+			for (std::size_t i = 0; i < outline.size(); i++) {
+				auto [ax, ay] = outline[i];
+				auto [bx, by] = outline[(i + 1) % outline.size()];
+				// Solve origin + t * ray = a + u * (b - a).
+				double ex = bx - ax;
+				double ey = by - ay;
+				double det = ex * dy - ey * dx;
+				if (std::abs(det) < 1e-12) {
+					continue;
+				}
+				double t = (ex * (ay - y) - ey * (ax - x)) / det;
+				double u = (dx * (ay - y) - dy * (ax - x)) / det;
+				if (t > 0 && u >= 0 && u <= 1) {
+					range = std::min(range, t);
+				}
+			}
+		}
+		return range;
+	}
+
+	void step(World& world, double) override {
+		elapsed++;
+		auto pose = placement();
+		double heading = pose.heading * M_PI / 180;
+
+		if (config.gps != 0) {
+			auto& gps = world.gps(config.gps);
+			if (gps.present && elapsed % std::max<std::uint32_t>(gps.data_rate, 5) == 0) {
+				double x = pose.x + random.normal(0, config.gps_noise);
+				double y = pose.y + random.normal(0, config.gps_noise);
+				if (random.uniform(0, 1) < config.gps_outliers) {
+					double angle = random.uniform(0, 2 * M_PI);
+					double jump = random.uniform(30, 80);
+					x += jump * std::sin(angle);
+					y += jump * std::cos(angle);
+				}
+				gps.x = x / 100;
+				gps.y = y / 100;
+				gps.heading = pose.heading + random.normal(0, config.gps_heading_noise);
+				gps.error = std::abs(random.normal(config.gps_noise, config.gps_noise / 4)) / 100;
+			}
+		}
+
+		if (elapsed % config.distance_rate != 0) {
+			return;
+		}
+		for (auto& mount : config.distances) {
+			auto& sensor = world.distance(mount.port);
+			double x = pose.x + mount.forward * std::sin(heading) + mount.right * std::cos(heading);
+			double y = pose.y + mount.forward * std::cos(heading) - mount.right * std::sin(heading);
+			double range = wall(x, y, heading + mount.angle * M_PI / 180);
+			if (random.uniform(0, 1) < config.distance_outliers) {
+				range *= random.uniform(0.1, 0.9);
+			}
+			range += random.normal(0, range < 20 ? 1.5 : range * 0.05);
+
+			if (range > 200 || range <= 0) {
+				sensor.range = 9999;
+				sensor.confidence = 0;
+				sensor.size = 0;
+			} else {
+				sensor.range = static_cast<std::int32_t>(range * 10);
+				sensor.confidence = range < 20 ? 0 : 63;
+				sensor.size = 400;
+			}
+		}
+	}
+};
+
+}
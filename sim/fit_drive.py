@@ -0,0 +1,128 @@
+import io
+import math
+import sys
+
+# Refits the drive and turn feedforwards from a terminal capture of
+# auto_characterize in src/main.cpp, whose Robot::characterize runs log
+#   [Characterize] drive|spin,ms,mV,speed,accel
+# every 10 ms, speed in cm/s driving and rad/s spinning, and then
+#   [Characterize] trackwidth,measured_cm,odom_cm
+# The robot's own fit differences speed over one row; here acceleration is
+# a central difference over SPAN rows either side, which is far less noisy
+# on a real robot's tracking wheels. Each row's speed is read after its
+# voltage has been applied for a row; raise LAG if the motors answer more
+# slowly than that. Each model is a least-squares fit of
+#   voltage = ks * sign(speed) + kv * speed + ka * acceleration
+# like Feedforward::fit, and the turn kv and ka are rescaled to the measured
+# trackwidth the way auto_characterize does.
+
+SPAN = 2            # rows either side for each difference
+LAG = 0             # extra rows the motors take to answer a new voltage
+GAP = 100           # ms between rows that splits one run from the next
+STILL = 1.0         # cm/s below which a sample says nothing about friction
+STILL_TURN = 0.02   # rad/s likewise for turning
+PREFIX = '[Characterize] '
+
+def load(path):
+    raw = open(path, 'rb').read()
+    text = raw.decode('utf-16') if raw[:2] in (b'\xff\xfe', b'\xfe\xff') else raw.decode()
+    rows, trackwidth = [], None
+    for line in io.StringIO(text):
+        if not line.startswith(PREFIX):
+            continue
+        fields = line[len(PREFIX):].strip().split(',')
+        try:
+            if fields[0] in ('drive', 'spin') and len(fields) == 5:
+                rows.append([fields[0]] + [float(value) for value in fields[1:]])
+            elif fields[0] == 'trackwidth' and len(fields) == 3:
+                trackwidth = (float(fields[1]), float(fields[2]))
+        except ValueError:
+            pass
+    return rows, trackwidth
+
+def runs(rows):
+    # characterize rests between runs, so a gap in the clock ends one.
+    out = []
+    for row in rows:
+        if not out or row[0] != out[-1][-1][0] or row[1] - out[-1][-1][1] > GAP:
+            out.append([])
+        out[-1].append(row)
+    return out
+
+def derivative(times, values):
+    out = []
+    for i in range(len(values)):
+        lo = max(0, i - SPAN)
+        hi = min(len(values) - 1, i + SPAN)
+        dt = (times[hi] - times[lo]) / 1000
+        out.append((values[hi] - values[lo]) / dt if dt > 0 else 0.0)
+    return out
+
+def samples(kind, rows):
+    out = []
+    for run in runs(rows):
+        if run[0][0] != kind:
+            continue
+        times = [row[1] for row in run]
+        speed = [row[3] for row in run]
+        accel = derivative(times, speed)
+        for i in range(LAG, len(run)):
+            out.append((run[i - LAG][2], speed[i], accel[i]))
+    return out
+
+def solve(samples, still):
+    # Normal equations for [ks, kv, ka], by Gauss-Jordan elimination.
+    a = [[0.0] * 4 for _ in range(3)]
+    for voltage, speed, accel in samples:
+        if abs(speed) < still:
+            continue
+        row = [math.copysign(1, speed), speed, accel]
+        for i in range(3):
+            for j in range(3):
+                a[i][j] += row[i] * row[j]
+            a[i][3] += row[i] * voltage
+    for col in range(3):
+        pivot = max(range(col, 3), key=lambda i: abs(a[i][col]))
+        a[col], a[pivot] = a[pivot], a[col]
+        if abs(a[col][col]) < 1e-9:
+            return None
+        for i in range(3):
+            if i != col:
+                factor = a[i][col] / a[col][col]
+                a[i] = [x - factor * y for x, y in zip(a[i], a[col])]
+    return [a[i][3] / a[i][i] for i in range(3)]
+
+def rms(samples, fit, still):
+    ks, kv, ka = fit
+    errors = [(v - (math.copysign(ks, s) + kv * s + ka * a)) ** 2 for v, s, a in samples if abs(s) >= still]
+    return math.sqrt(sum(errors) / len(errors)) if errors else 0.0
+
+def report(name, samples, still, units):
+    result = solve(samples, still)
+    if result is None:
+        print(f'{name}: not enough motion to fit')
+        return None
+    ks, kv, ka = result
+    print(f'{name}: ks {ks:.0f} mV, kv {kv:.4g} mV per {units}, ka {ka:.4g} mV per {units}/s, '
+          f'rms {rms(samples, result, still):.0f} mV over {len(samples)} rows')
+    return ks, kv, ka
+
+if __name__ == '__main__':
+    rows, trackwidth = load(sys.argv[1] if len(sys.argv) > 1 else 'characterize.log')
+    print(f'{len(rows)} rows in {len(runs(rows))} runs')
+    drive = report('drive', samples('drive', rows), STILL, 'cm/s')
+    turn = report('turn', samples('spin', rows), STILL_TURN, 'rad/s')
+
+    # The constants at the top of src/main.cpp.
+    print()
+    scale = trackwidth[0] / trackwidth[1] if trackwidth else 1
+    if drive:
+        for name, value in zip(('KS', 'KV', 'KA'), drive):
+            print(f'constexpr double DRIVE_{name} = {value:.4g};')
+    if turn:
+        for name, value in zip(('KS', 'KV', 'KA'), (turn[0], turn[1] * scale, turn[2] * scale)):
+            print(f'constexpr double TURN_{name} = {value:.4g};')
+    if trackwidth:
+        print(f'constexpr double TRACKING_WIDTH = {trackwidth[0] / 2.54:.3f} * INCH_TO_CM;')
+    else:
+        print('// no trackwidth line in the log, so the turn constants are on Odom\'s')
@@ -0,0 +1,83 @@
+import csv
+import io
+import math
+import sys
+
+# Fits the flywheel plant in sim/flywheel.hpp to a run logged by Flywheel::loop
+# (setpoint,voltage,vel,accel every 10 ms). The recorded voltages are replayed
+# open loop through the same model the simulator uses, and the parameters are
+# refined one at a time until the simulated rpm stops getting closer. Coulomb
+# friction only shows apart from the torque slope where the flywheel coasts,
+# so a log that never cuts the voltage fits it at or near zero.
+
+PERIOD = 0.01       # s between log rows
+STEPS = 10          # 1 ms model steps per row
+GEAR = 6.0          # flywheel turns per motor turn
+FREE = 600.0        # rpm, blue cartridge
+STALL = 2.1 * 600.0 / 3600.0  # N*m, 11W motor at the blue cartridge shaft
+
+def load(path):
+    raw = open(path, 'rb').read()
+    text = raw.decode('utf-16') if raw[:2] in (b'\xff\xfe', b'\xfe\xff') else raw.decode()
+    rows = []
+    for row in csv.reader(io.StringIO(text)):
+        try:
+            rows.append([float(value) for value in row[:4]])
+        except (ValueError, IndexError):
+            pass
+    return rows
+
+def shots(rows):
+    # A disc shows up as one row where the flywheel loses more than 100 rpm
+    # while the controller is still pushing.
+    return {i for i in range(1, len(rows)) if rows[i][2] - rows[i - 1][2] < -100 and rows[i][1] > 4000}
+
+def simulate(rows, fired, inertia, stall_ratio, viscous, friction, impulse):
+    omega = 0.0
+    trace = []
+    for i, row in enumerate(rows):
+        load = impulse / PERIOD if i + 1 in fired else 0.0
+        for _ in range(STEPS):
+            motor_rpm = omega * 60 / (2 * math.pi) / GEAR
+            torque = STALL * stall_ratio * (row[1] / 12000 - motor_rpm / FREE)
+            torque = max(-STALL, min(STALL, torque)) if row[1] != 0 else 0.0
+            # Coulomb friction smoothed through zero as sim/flywheel.hpp does.
+            drag = viscous * omega + friction * math.tanh(omega / 0.5)
+            omega += (torque / GEAR - drag - load) / inertia * PERIOD / STEPS
+        trace.append(omega * 60 / (2 * math.pi))
+    return trace
+
+def error(rows, fired, params):
+    trace = simulate(rows, fired, *params)
+    return math.sqrt(sum((a - row[2]) ** 2 for a, row in zip(trace, rows)) / len(rows))
+
+def fit(rows):
+    # Inertia and stall ratio trade off along a narrow valley, so start from
+    # the best point of a coarse grid before refining.
+    fired = shots(rows)
+    grid = [[j * 1e-5, r / 10, 0.0, 0.0, 3e-3] for j in range(8, 31, 2) for r in range(10, 41, 2)]
+    params = min(grid, key=lambda trial: error(rows, fired, trial))
+    steps = [1e-5, 0.1, 2e-6, 5e-4, 1e-3]
+    best = error(rows, fired, params)
+    for _ in range(12):
+        for k in range(len(params)):
+            for sign in (1, -1):
+                while True:
+                    trial = list(params)
+                    trial[k] = max(0.0, trial[k] + sign * steps[k])
+                    score = error(rows, fired, trial)
+                    if score >= best:
+                        break
+                    params, best = trial, score
+        steps = [step / 2 for step in steps]
+    return params, best, fired
+
+if __name__ == '__main__':
+    rows = load(sys.argv[1] if len(sys.argv) > 1 else 'data.csv')
+    (inertia, stall_ratio, viscous, friction, impulse), rms, fired = fit(rows)
+    print(f'{len(rows)} rows, {len(fired)} shots, rms {rms:.1f} rpm')
+    print(f'inertia = {inertia:.4g};  // kg*m^2 at the flywheel')
+    print(f'stall_ratio = {stall_ratio:.3g};')
+    print(f'viscous = {viscous:.3g};  // N*m per rad/s')
+    print(f'friction = {friction:.3g};  // N*m of bearing friction')
+    print(f'shot_impulse = {impulse:.3g};  // N*m*s')
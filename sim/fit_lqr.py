@@ -0,0 +1,82 @@
+import math
+import sys
+
+from fit_flywheel import FREE, GEAR, PERIOD, STALL, fit, load
+
+# Designs the StateSpace flywheel controller in include/hbot.hpp from a run
+# logged by Flywheel::loop, the same log fit_flywheel.py reads. That log is
+# closed loop, so the voltage follows the speed and cannot be regressed on
+# directly; instead the motor model fit_flywheel.py fits is linearised to
+#   rpm[k+1] = a * rpm[k] + b * (mV[k] + load[k])
+# where load is the voltage lost to friction, model error and discs, so the
+# fitted Coulomb friction is left to the load estimate rather than the model. A
+# steady-state Kalman filter estimates rpm and load from the rotation sensor
+# and the motors' own velocity, and an LQR gain acts on the speed error.
+
+SENSOR_NOISE = 10    # rpm, rotation sensor velocity at a 10 ms data rate
+MOTOR_NOISE = 40     # rpm, motor velocity times the gear ratio
+SPEED_DRIFT = 5      # rpm per step the model misses
+LOAD_DRIFT = 150     # mV per step the load can change by
+MAX_ERROR = 40       # rpm of error worth the whole voltage range (Bryson's rule)
+MAX_VOLTAGE = 12000  # mV
+
+def linearise(inertia, stall_ratio, viscous):
+    # Motor torque is STALL * stall_ratio * (mV / 12000 - motor rpm / FREE)
+    # until it current limits, so in rpm per second:
+    to_rpm = 60 / (2 * math.pi)
+    slope = STALL * stall_ratio / GEAR / inertia
+    alpha = slope / (GEAR * FREE) * to_rpm + viscous / inertia
+    beta = slope / 12000 * to_rpm
+    a = math.exp(-alpha * PERIOD)
+    return a, beta * (1 - a) / alpha
+
+def multiply(x, y):
+    return [[sum(x[i][k] * y[k][j] for k in range(len(y))) for j in range(len(y[0]))] for i in range(len(x))]
+
+def transpose(x):
+    return [list(row) for row in zip(*x)]
+
+def inverse(x):
+    det = x[0][0] * x[1][1] - x[0][1] * x[1][0]
+    return [[x[1][1] / det, -x[0][1] / det], [-x[1][0] / det, x[0][0] / det]]
+
+def kalman(a, b):
+    # States [rpm, load mV]; both readings measure rpm.
+    f = [[a, b], [0, 1]]
+    h = [[1, 0], [1, 0]]
+    q = [[SPEED_DRIFT ** 2, 0], [0, LOAD_DRIFT ** 2]]
+    r = [[SENSOR_NOISE ** 2, 0], [0, MOTOR_NOISE ** 2]]
+    p = q
+    gain = None
+    for _ in range(2000):
+        prior = multiply(multiply(f, p), transpose(f))
+        prior = [[prior[i][j] + q[i][j] for j in range(2)] for i in range(2)]
+        s = multiply(multiply(h, prior), transpose(h))
+        s = [[s[i][j] + r[i][j] for j in range(2)] for i in range(2)]
+        gain = multiply(multiply(prior, transpose(h)), inverse(s))
+        kh = multiply(gain, h)
+        p = multiply([[(i == j) - kh[i][j] for j in range(2)] for i in range(2)], prior)
+    return gain
+
+def lqr(a, b):
+    q = 1 / MAX_ERROR ** 2
+    r = 1 / MAX_VOLTAGE ** 2
+    p = q
+    for _ in range(1000):
+        p = q + a * a * p - (a * b * p) ** 2 / (r + b * b * p)
+    return a * b * p / (r + b * b * p)
+
+if __name__ == '__main__':
+    rows = load(sys.argv[1] if len(sys.argv) > 1 else 'data.csv')
+    (inertia, stall_ratio, viscous, _, impulse), rms, fired = fit(rows)
+    a, b = linearise(inertia, stall_ratio, viscous)
+    gain = lqr(a, b)
+    (sensor_rpm, motor_rpm), (sensor_load, motor_load) = kalman(a, b)
+    print(f'{len(rows)} rows, {len(fired)} shots, rms {rms:.1f} rpm')
+    print(f'model: rpm[k+1] = {a:.5f} rpm[k] + {b:.5f} mV, time constant {-PERIOD * 1000 / math.log(a):.0f} ms, '
+          f'{(1 - a) / b:.3f} mV per rpm held')
+    print(f'kalman: rpm takes {sensor_rpm:.3f} of the sensor and {motor_rpm:.3f} of the motor, '
+          f'load {sensor_load:.2f} and {motor_load:.2f} mV per rpm')
+    print(f'lqr: {gain:.1f} mV per rpm')
+    print(f'StateSpace::create({a:.5f}, {b:.5f}, {gain:.1f}, {sensor_rpm:.3f}, {motor_rpm:.3f}, '
+          f'{sensor_load:.2f}, {motor_load:.2f})')
@@ -0,0 +1,356 @@
+#include "robot.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// Runs the robot's Flywheel class against the fitted flywheel plant: spins up
+// to a target, fires a volley through the Indexer and reports spin-up time,
+// overshoot and how long the flywheel takes to come back after each disc.
+// With --mode all it runs every Flywheel::Mode and compares them, and --map
+// checks ShotMap against a badly formed table instead.
+
+struct Sample {
+	double rpm;
+	double voltage;
+};
+
+// Logs the flywheel once per millisecond, after the plant has stepped.
+class Recorder : public sim::Plant {
+	const sim::FlywheelPlant& plant;
+	std::int8_t port;
+public:
+	std::vector<Sample> samples;
+
+	Recorder(const sim::FlywheelPlant& iplant) : plant(iplant), port(iplant.config.motors.at(0)) {
+	}
+
+	void step(sim::World& world, double) override {
+		double mount = port < 0 ? -1.0 : 1.0;
+		samples.push_back({plant.rpm(), mount * world.motor(port).voltage});
+	}
+};
+
+// First time at or after start where the flywheel is within band of target
+// and stays there for hold ms without passing end. Returns end if it never does.
+static std::uint32_t settle(const std::vector<Sample>& samples, std::uint32_t start, std::uint32_t end,
+                            double target, double band, std::uint32_t hold) {
+	std::uint32_t entered = start;
+	for (std::uint32_t t = start; t < end; t++) {
+		if (std::abs(samples[t].rpm - target) > band) {
+			entered = t + 1;
+		} else if (t + 1 - entered >= hold) {
+			return entered;
+		}
+	}
+	return end;
+}
+
+struct Options {
+	double kp = 150, ki = 0, kd = 0, kb = 895, kf = 2.6;
+	unsigned long period = 10;
+	double target = 2340;
+	int shots = 3;
+	unsigned long interval = 200;
+	std::uint32_t spinup = 3000;
+	double band = 50;
+	std::uint32_t hold = 50;
+	double tbh = Flywheel::TBH_GAIN;
+	// As passed to StateSpace::create in src/main.cpp.
+	double lqr[7] = {0.97835, 0.00649, 123.6, 0.456, 0.028, 10.45, 0.65};
+	double boost = Flywheel::SHOT_BOOST;
+	unsigned lead = Flywheel::SHOT_LEAD;
+	unsigned length = Flywheel::SHOT_LENGTH;
+	bool gate = false;
+	bool ready = false;       // fire with repeat_ready instead of repeat
+	Indexer::Readiness readiness;
+};
+
+struct Shot {
+	std::uint32_t at;         // ms
+	double rpm;               // at contact
+	double dip;               // rpm below the target at the lowest
+	std::uint32_t recovery;   // ms from contact, 0 if it never recovered
+};
+
+struct Run {
+	std::vector<Sample> samples;
+	std::uint32_t ready = 0;  // ms to spin up, 0 if it never settled
+	double overshoot = 0;
+	double steady = 0;        // rpm off the target before the first shot
+	double voltage = 0;       // mV then
+	std::vector<Shot> shots;
+	std::uint32_t volley = 0; // ms from the first contact to the last
+	double spread = 0;        // rpm between the fastest and slowest contact
+	double contact = 0;       // mean rpm at contact
+	std::vector<unsigned long> waits;  // ms each disc waited, with --ready
+};
+
+static const char* MODES[] = {"pidf", "bangbang", "hold", "tbh", "lqr"};
+
+static Run run(const Options& o, Flywheel::Mode mode) {
+	sim::World world;
+	auto& plant = world.attach<sim::FlywheelPlant>(world, sim::hbot_flywheel());
+	auto& recorder = world.attach<Recorder>(plant);
+
+	std::unique_ptr<Flywheel> flywheel;
+	std::unique_ptr<Indexer> indexer;
+	std::vector<unsigned long> result_waits;
+	world.run([&] {
+		flywheel = Flywheel::create({-10}, pros::Rotation(9), PID::create(o.kp, o.ki, o.kd, o.kb, o.kf, o.period),
+		                            StateSpace::create(o.lqr[0], o.lqr[1], o.lqr[2], o.lqr[3], o.lqr[4], o.lqr[5], o.lqr[6]));
+		indexer = Indexer::create(pros::ADIDigitalOut('B'), 100, o.interval);
+		// Wired as Robot wires them.
+		indexer->on_fire([&] { flywheel->fired(); });
+		if (o.gate || o.ready) {
+			indexer->set_gate([&](double band, double rate) { return flywheel->ready(band, rate); });
+		}
+		flywheel->set_shot_boost(o.boost, o.lead, o.length);
+		flywheel->use(mode);
+		if (mode == Flywheel::Mode::tbh) {
+			flywheel->use_tbh(o.tbh);
+		}
+		flywheel->move(o.target);
+		flywheel->enable();
+		pros::delay(o.spinup);
+		if (o.ready) {
+			indexer->repeat_ready(o.shots, o.readiness);
+			result_waits = indexer->get_waits();
+		} else if (o.shots > 0) {
+			indexer->repeat(o.shots);
+		}
+		pros::delay(1000);
+	});
+
+	Run result;
+	result.waits = result_waits;
+	auto& samples = recorder.samples;
+	std::uint32_t end = samples.size();
+	std::uint32_t first_shot = plant.shots.empty() ? end : plant.shots.front();
+
+	// Spin-up ends when the first disc fires, before the shot boost.
+	std::uint32_t fired = plant.shots.empty() ? end : first_shot - plant.config.shot_delay;
+	for (std::uint32_t t = 0; t < fired; t++) {
+		result.overshoot = std::max(result.overshoot, samples[t].rpm - o.target);
+	}
+	std::uint32_t window = std::min<std::uint32_t>(500, fired);
+	for (std::uint32_t t = fired - window; t < fired; t++) {
+		result.steady += (samples[t].rpm - o.target) / window;
+	}
+	result.voltage = samples[fired - 1].voltage;
+	std::uint32_t ready = settle(samples, 0, fired, o.target, o.band, o.hold);
+	result.ready = ready < fired ? ready : 0;
+
+	for (std::size_t i = 0; i < plant.shots.size(); i++) {
+		std::uint32_t start = plant.shots[i];
+		std::uint32_t next = i + 1 < plant.shots.size() ? plant.shots[i + 1] : end;
+		double low = samples[start].rpm;
+		for (std::uint32_t t = start; t < next; t++) {
+			low = std::min(low, samples[t].rpm);
+		}
+		std::uint32_t recovered = settle(samples, start + plant.config.shot_contact, next, o.target, o.band, o.hold);
+		result.shots.push_back({start, samples[start].rpm, o.target - low, recovered < next ? recovered - start : 0});
+	}
+	if (!result.shots.empty()) {
+		auto [slowest, fastest] = std::minmax_element(result.shots.begin(), result.shots.end(),
+		                                              [](const Shot& a, const Shot& b) { return a.rpm < b.rpm; });
+		result.volley = result.shots.back().at - result.shots.front().at;
+		result.spread = fastest->rpm - slowest->rpm;
+		for (auto& shot : result.shots) {
+			result.contact += shot.rpm / result.shots.size();
+		}
+	}
+
+	flywheel.reset();
+	indexer.reset();
+	result.samples = std::move(samples);
+	return result;
+}
+
+// Whether the discs met the flywheel within the band the Indexer fires in,
+// on average, since the shot map's speeds are for the disc at contact.
+static bool contact_ok(const Run& r, double target) {
+	return r.shots.empty() || std::abs(r.contact - target) <= Flywheel::READY_BAND;
+}
+
+static void print_shots(const Run& r) {
+	if (!r.shots.empty()) {
+		std::printf("\n%5s %9s %9s %9s %9s %9s\n", "shot", "at ms", "rpm", "dip", "recovery", "waited");
+	}
+	for (std::size_t i = 0; i < r.shots.size(); i++) {
+		auto& shot = r.shots[i];
+		char recovery[32] = "not recovered";
+		if (shot.recovery > 0) {
+			std::snprintf(recovery, sizeof(recovery), "%u ms", shot.recovery);
+		}
+		char waited[16] = "-";
+		if (i < r.waits.size()) {
+			std::snprintf(waited, sizeof(waited), "%lu ms", r.waits[i]);
+		}
+		std::printf("%5zu %9u %9.0f %9.0f %9s %9s\n", i + 1, shot.at, shot.rpm, shot.dip, recovery, waited);
+	}
+}
+
+// Fits the normal table from src/main.cpp as given and again shuffled with
+// its 200 cm point split into two that average to it, a repeat of another
+// point and one that is not a number. Both must read the same everywhere,
+// finite and never falling with distance.
+static int check_map() {
+	std::vector<ShotMap::Point> table = {{140, 1900}, {160, 1950}, {200, 2150}, {250, 2300}, {270, 2400}, {300, 2440}};
+	std::vector<ShotMap::Point> messy = {{270, 2400}, {200, 2100}, {140, 1900}, {300, 2440}, {160, 1950},
+	                                     {250, 2300}, {200, 2200}, {160, 1950}, {NAN, 2000}};
+	auto clean = ShotMap::create(table, table);
+	auto merged = ShotMap::create(messy, messy);
+
+	double worst = 0, prev = 0;
+	bool finite = true, rising = true;
+	for (double d = 100; d <= 340; d += 0.5) {
+		double a = clean->rpm(d, false);
+		double b = merged->rpm(d, false);
+		finite = finite && std::isfinite(a) && std::isfinite(b);
+		rising = rising && (d == 100 || b >= prev);
+		worst = std::max(worst, std::abs(a - b));
+		prev = b;
+	}
+	bool ok = finite && rising && worst < 1e-9;
+	std::printf("shot map: %s, %s, %.3g rpm from the clean table: %s\n", finite ? "finite" : "not finite",
+	            rising ? "rising" : "falls", worst, ok ? "ok" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+	Options o;
+	const char* trace = nullptr;
+	const char* mode = "pidf";
+
+	for (int i = 1; i < argc; i++) {
+		if (!std::strcmp(argv[i], "--pid") && i + 1 < argc) {
+			if (std::sscanf(argv[++i], "%lf,%lf,%lf,%lf,%lf,%lu", &o.kp, &o.ki, &o.kd, &o.kb, &o.kf, &o.period) != 6) {
+				std::fprintf(stderr, "--pid takes kp,ki,kd,kb,kf,interval as passed to PID::create\n");
+				return 2;
+			}
+		} else if (!std::strcmp(argv[i], "--mode") && i + 1 < argc) {
+			mode = argv[++i];
+		} else if (!std::strcmp(argv[i], "--tbh") && i + 1 < argc) {
+			o.tbh = std::atof(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--lqr") && i + 1 < argc) {
+			double* l = o.lqr;
+			if (std::sscanf(argv[++i], "%lf,%lf,%lf,%lf,%lf,%lf,%lf", &l[0], &l[1], &l[2], &l[3], &l[4], &l[5], &l[6]) != 7) {
+				std::fprintf(stderr, "--lqr takes the seven numbers passed to StateSpace::create\n");
+				return 2;
+			}
+		} else if (!std::strcmp(argv[i], "--boost") && i + 1 < argc) {
+			if (std::sscanf(argv[++i], "%lf,%u,%u", &o.boost, &o.lead, &o.length) != 3) {
+				std::fprintf(stderr, "--boost takes mV,lead ms,length ms as passed to Flywheel::set_shot_boost\n");
+				return 2;
+			}
+		} else if (!std::strcmp(argv[i], "--gate")) {
+			o.gate = true;
+		} else if (!std::strcmp(argv[i], "--ready") && i + 1 < argc) {
+			o.ready = true;
+			if (std::sscanf(argv[++i], "%lf,%lf,%lu", &o.readiness.band, &o.readiness.rate, &o.readiness.timeout) != 3) {
+				std::fprintf(stderr, "--ready takes band rpm,rate rpm/s,timeout ms as in Indexer::Readiness\n");
+				return 2;
+			}
+		} else if (!std::strcmp(argv[i], "--rpm") && i + 1 < argc) {
+			o.target = std::atof(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--shots") && i + 1 < argc) {
+			o.shots = std::max(0, std::atoi(argv[++i]));
+		} else if (!std::strcmp(argv[i], "--interval") && i + 1 < argc) {
+			o.interval = std::atol(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--spinup") && i + 1 < argc) {
+			o.spinup = std::atol(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--band") && i + 1 < argc) {
+			o.band = std::atof(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--trace") && i + 1 < argc) {
+			trace = argv[++i];
+		} else if (!std::strcmp(argv[i], "--map")) {
+			return check_map();
+		} else {
+			std::fprintf(stderr, "usage: %s [--pid kp,ki,kd,kb,kf,interval] [--mode pidf|bangbang|hold|tbh|lqr|all] "
+			             "[--tbh gain] [--lqr a,b,k,...] [--boost mV,lead,length] [--gate] [--ready band,rate,timeout] [--rpm target] [--shots n] "
+			             "[--interval ms] [--spinup ms] [--band rpm] [--trace file.csv] [--map]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	int chosen = -1;
+	for (int m = 0; m < static_cast<int>(std::size(MODES)); m++) {
+		if (!std::strcmp(mode, MODES[m])) {
+			chosen = m;
+		}
+	}
+	if (chosen < 0 && std::strcmp(mode, "all") != 0) {
+		std::fprintf(stderr, "--mode is one of pidf, bangbang, hold, tbh, lqr or all\n");
+		return 2;
+	}
+
+	std::printf("pid:      PID::create(%g, %g, %g, %g, %g, %lu)\n", o.kp, o.ki, o.kd, o.kb, o.kf, o.period);
+	std::printf("target:   %.0f rpm, band +/-%.0f rpm held %u ms\n", o.target, o.band, o.hold);
+	if (o.ready) {
+		std::printf("shots:    %d when within %g rpm and %g rpm/s or after %lu ms, boost %g mV from %u ms for %u ms\n",
+		            o.shots, o.readiness.band, o.readiness.rate, o.readiness.timeout, o.boost, o.lead, o.length);
+	} else {
+		std::printf("shots:    %d, %s, boost %g mV from %u ms for %u ms\n", o.shots,
+		            o.gate ? "gated" : "fixed interval", o.boost, o.lead, o.length);
+	}
+
+	if (chosen < 0) {
+		// One row per mode: recovery is the worst over the volley.
+		std::printf("\n%-9s %9s %9s %9s %9s %9s %9s %9s %9s %9s  %s\n", "mode", "spin-up", "overshoot", "steady", "worst dip",
+		            "recovery", "mean", "volley", "spread", "contact", "check");
+		bool ok = true;
+		for (int m = 0; m < static_cast<int>(std::size(MODES)); m++) {
+			auto r = run(o, static_cast<Flywheel::Mode>(m));
+			double dip = 0, mean = 0;
+			std::uint32_t worst = 0;
+			bool recovered = true;
+			for (auto& shot : r.shots) {
+				dip = std::max(dip, shot.dip);
+				worst = std::max(worst, shot.recovery);
+				mean += shot.recovery / static_cast<double>(r.shots.size());
+				recovered = recovered && shot.recovery > 0;
+			}
+			char ready[16] = "never", worst_text[16] = "never", mean_text[16] = "-";
+			if (r.ready > 0) {
+				std::snprintf(ready, sizeof(ready), "%u ms", r.ready);
+			}
+			if (recovered && !r.shots.empty()) {
+				std::snprintf(worst_text, sizeof(worst_text), "%u ms", worst);
+				std::snprintf(mean_text, sizeof(mean_text), "%.0f ms", mean);
+			}
+			bool contact = contact_ok(r, o.target);
+			ok = ok && contact;
+			std::printf("%-9s %9s %9.1f %+9.1f %9.0f %9s %9s %6u ms %9.0f %9.0f  %s\n", MODES[m], ready, std::max(0.0, r.overshoot),
+			            r.steady, dip, worst_text, mean_text, r.volley, r.spread, r.contact, contact ? "ok" : "FAIL");
+		}
+		return ok ? 0 : 1;
+	}
+
+	auto r = run(o, static_cast<Flywheel::Mode>(chosen));
+	std::printf("mode:     %s\n", MODES[chosen]);
+	if (r.ready > 0) {
+		std::printf("spin-up:  %u ms\n", r.ready);
+	} else {
+		std::printf("spin-up:  not settled\n");
+	}
+	std::printf("overshoot: %.1f rpm\n", std::max(0.0, r.overshoot));
+	std::printf("steady:   %+.1f rpm at %.0f mV\n", r.steady, r.voltage);
+	if (!r.shots.empty()) {
+		std::printf("volley:   %u ms, %.0f rpm between the fastest and slowest shot\n", r.volley, r.spread);
+		std::printf("contact:  %.0f rpm on average, within %.0f rpm: %s\n", r.contact, Flywheel::READY_BAND,
+		            contact_ok(r, o.target) ? "ok" : "FAIL");
+	}
+	print_shots(r);
+
+	if (trace != nullptr) {
+		std::ofstream file(trace);
+		file << "time_ms,setpoint,rpm,voltage\n";
+		for (std::uint32_t t = 0; t < r.samples.size(); t++) {
+			file << t << "," << o.target << "," << r.samples[t].rpm << "," << r.samples[t].voltage << "\n";
+		}
+	}
+	return contact_ok(r, o.target) ? 0 : 1;
+}
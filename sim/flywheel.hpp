@@ -0,0 +1,112 @@
+#pragma once
+#include "sim.hpp"
+#include <cmath>
+#include <vector>
+
+namespace sim {
+
+// Defaults are fitted to data.csv with fit_flywheel.py.
+struct FlywheelConfig {
+	// Signed ports exactly as passed to Flywheel::create.
+	std::vector<std::int8_t> motors;
+	pros::motor_gearset_e_t cartridge = pros::E_MOTOR_GEARSET_06;
+	double gear_ratio = 6;                      // flywheel turns per motor turn
+	double stall_ratio = 2.44;                  // see Motor::stall_ratio
+
+	// Rotation sensor on the flywheel shaft, as passed to Flywheel::create.
+	std::uint8_t sensor = 0;
+	double sensor_mount = 1;
+
+	double inertia = 1.72e-4;                   // kg*m^2 at the flywheel
+	double viscous = 0;                         // N*m per rad/s
+	// Hand-set, not fitted: data.csv never cuts the voltage, so
+	// fit_flywheel.py cannot tell friction from the torque slope and fits
+	// it at zero. This much lets the flywheel coast down between shots.
+	double friction = 2e-3;                     // N*m of bearing friction
+
+	// Each rising edge on the indexer's ADI port pushes a disc into the
+	// flywheel, which takes the impulse out of it over the contact time.
+	std::uint8_t indexer = 0;                   // ADI port, 'A'-'H'
+	std::uint32_t shot_delay = 40;              // ms from extension to contact
+	std::uint32_t shot_contact = 10;            // ms
+	double shot_impulse = 3.16e-3;              // N*m*s
+};
+
+// Single flywheel driven through a fixed gear ratio, in the shape of okapi's
+// FlywheelSimulator: inertia, viscous and Coulomb friction and an external
+// load torque, here from discs passing through. Keeps a log of every shot so
+// benchmarks can measure recovery.
+class FlywheelPlant : public Plant {
+public:
+	FlywheelConfig config;
+	double velocity = 0;                        // rad/s
+	std::uint32_t elapsed = 0;                  // ms since attached
+	std::vector<std::uint32_t> shots;           // contact start times, ms
+
+	FlywheelPlant(World& world, FlywheelConfig iconfig) : config(std::move(iconfig)) {
+		for (auto port : config.motors) {
+			auto& motor = world.motor(port);
+			motor.claimed = true;
+			motor.cartridge = config.cartridge;
+			motor.stall_ratio = config.stall_ratio;
+		}
+		if (config.sensor != 0) {
+			world.rotation(config.sensor);
+		}
+	}
+
+	inline double rpm() const {
+		return velocity * 60 / (2 * M_PI);
+	}
+
+	void step(World& world, double dt) override {
+		elapsed++;
+
+		double torque = 0;
+		double shaft_rpm = rpm() / config.gear_ratio;
+		for (auto port : config.motors) {
+			double mount = port < 0 ? -1.0 : 1.0;
+			auto& motor = world.motor(port);
+			motor.velocity = mount * shaft_rpm;
+			motor.position += motor.velocity * 6 * dt;
+			motor.torque = motor.torque_at(motor.velocity);
+			torque += mount * motor.torque / config.gear_ratio;
+		}
+
+		torque -= config.viscous * velocity + config.friction * std::tanh(velocity / 0.5);
+		torque -= shot_load(world);
+		velocity += torque / config.inertia * dt;
+
+		if (config.sensor != 0) {
+			world.rotation(config.sensor).angle += config.sensor_mount * velocity * dt * 180 / M_PI;
+		}
+	}
+
+private:
+	bool piston = false;
+	std::vector<std::uint32_t> pending;
+
+	double shot_load(World& world) {
+		if (config.indexer == 0) {
+			return 0;
+		}
+
+		bool extended = world.adi_port(config.indexer) != 0;
+		if (extended && !piston) {
+			pending.push_back(elapsed + config.shot_delay);
+		}
+		piston = extended;
+
+		if (!pending.empty() && pending.front() == elapsed) {
+			shots.push_back(elapsed);
+			pending.erase(pending.begin());
+		}
+
+		if (!shots.empty() && elapsed - shots.back() < config.shot_contact) {
+			return config.shot_impulse / (config.shot_contact / 1000.0);
+		}
+		return 0;
+	}
+};
+
+}
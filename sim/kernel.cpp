@@ -0,0 +1,162 @@
+#include "sim.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+namespace sim {
+
+static thread_local Kernel* active = nullptr;
+
+Kernel::Kernel() {
+	auto host = std::make_unique<Task>();
+	host->name = "host";
+	host->started = true;
+	running = host.get();
+	tasks.push_back(std::move(host));
+	active = this;
+}
+
+Kernel::~Kernel() {
+	if (active == this) {
+		active = nullptr;
+	}
+}
+
+Kernel::Task* Kernel::spawn(pros::task_fn_t function, void* parameters, std::uint32_t priority, const char* name) {
+	auto task = std::make_unique<Task>();
+	task->function = function;
+	task->parameters = parameters;
+	task->priority = priority;
+	task->name = name ? name : "";
+	task->wake = now;
+	task->order = ++counter;
+	task->stack = std::make_unique<char[]>(STACK_SIZE);
+
+	getcontext(&task->context);
+	task->context.uc_stack.ss_sp = task->stack.get();
+	task->context.uc_stack.ss_size = STACK_SIZE;
+	task->context.uc_link = nullptr;
+	makecontext(&task->context, &Kernel::entry, 0);
+
+	tasks.push_back(std::move(task));
+	return tasks.back().get();
+}
+
+void Kernel::remove(Task* task) {
+	if (task == nullptr || task->done) {
+		return;
+	}
+	if (task == running) {
+		throw TaskKilled{};
+	}
+	task->killed = true;
+	task->suspended = false;
+	task->wake = now;
+	task->order = ++counter;
+}
+
+void Kernel::remove_all() {
+	for (auto& task : tasks) {
+		if (task.get() != host()) {
+			remove(task.get());
+		}
+	}
+
+	std::uint32_t saved = deadline;
+	deadline = UINT32_MAX;
+	bool pending = true;
+	while (pending) {
+		pending = false;
+		for (auto& task : tasks) {
+			pending |= task.get() != host() && !task->done;
+		}
+		if (pending) {
+			yield();
+		}
+	}
+	deadline = saved;
+}
+
+void Kernel::delay(std::uint32_t ms) {
+	running->wake = now + ms;
+	running->order = ++counter;
+	dispatch();
+}
+
+void Kernel::delay_until(std::uint32_t* prev_time, std::uint32_t delta) {
+	std::uint32_t wake = *prev_time + delta;
+	*prev_time = wake;
+	running->wake = wake > now ? wake : now;
+	running->order = ++counter;
+	dispatch();
+}
+
+void Kernel::yield() {
+	delay(0);
+}
+
+Kernel::Task* Kernel::next() {
+	Task* best = nullptr;
+	for (auto& task : tasks) {
+		if (task->done || task->suspended) {
+			continue;
+		}
+		if (best == nullptr || task->wake < best->wake ||
+		    (task->wake == best->wake && task->order < best->order)) {
+			best = task.get();
+		}
+	}
+	return best;
+}
+
+void Kernel::dispatch() {
+	Task* task = next();
+	if (task == nullptr) {
+		std::fprintf(stderr, "sim: every task is suspended\n");
+		std::abort();
+	}
+
+	while (now < task->wake) {
+		now++;
+		if (on_tick) {
+			on_tick(now);
+		}
+	}
+
+	switch_to(task);
+}
+
+void Kernel::switch_to(Task* task) {
+	Task* self = running;
+	if (task != self && !_setjmp(self->jump)) {
+		running = task;
+		if (task->started) {
+			_longjmp(task->jump, 1);
+		}
+		task->started = true;
+		setcontext(&task->context);
+	}
+
+	if (running->killed) {
+		throw TaskKilled{};
+	}
+	if (running == host() && now >= deadline) {
+		throw Timeout{};
+	}
+}
+
+void Kernel::entry() {
+	Kernel& kernel = *active;
+	Task* task = kernel.running;
+
+	if (!task->killed) {
+		try {
+			task->function(task->parameters);
+		} catch (const TaskKilled&) {
+		}
+	}
+
+	task->done = true;
+	kernel.dispatch();
+}
+
+}
@@ -0,0 +1,327 @@
+#include "robot.hpp"
+#include "field.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// Drives laps of a square on a walled field, steering on the true pose, while
+// a plain Odom and one corrected by a Localizer watch. The tracking wheels are
+// a little bigger than Odom thinks and the robot gets shoved sideways, so the
+// plain Odom drifts off; each scenario feeds the Localizer different sensors
+// and noise and checks it keeps the pose on the field without ever stepping it.
+// With --particles it instead benchmarks the ParticleFilter at each count:
+// host time per update, what the Odom tick that runs it would take on the V5,
+// and the error it holds.
+
+constexpr std::uint8_t GPS_PORT = 4;
+constexpr double TRACKING_SCALE = 1.02;   // true over assumed tracking wheel size
+
+const sim::Placement START = {-90, -90, 0};
+
+// Square the robot laps, cm on the field.
+const std::vector<std::pair<double, double>> CORNERS = {{-90, 90}, {90, 90}, {90, -90}, {-90, -90}};
+
+struct Shove {
+	std::uint32_t time;      // ms
+	double force;            // N to the robot's right
+	std::uint32_t duration;  // ms
+};
+
+const std::vector<Shove> SHOVES = {{8000, 100, 250}, {19000, -110, 250}, {30000, 100, 300}, {38000, -100, 250}};
+
+// A block in the middle of the field the inward-facing sensors see.
+const std::vector<std::pair<double, double>> OBSTACLE = {{-30, -30}, {-30, 30}, {30, 30}, {30, -30}};
+
+const std::vector<sim::DistanceMount> DISTANCES = {
+	{1, 15, 0, 0},
+	{2, 0, 15, 90},
+	{3, -15, 0, 180},
+	{5, 0, -15, -90},
+};
+
+struct Scenario {
+	const char* name;
+	bool gps;
+	bool distances;
+	double gps_noise = 1.0;
+	double gps_outliers = 0;
+	double distance_outliers = 0;
+	std::size_t particles = 0;   // distance sensors go through a ParticleFilter this size
+	bool reverse = false;        // lap backwards
+};
+
+const std::vector<Scenario> SCENARIOS = {
+	{"gps", true, false},
+	{"gps noisy", true, false, 5.0},
+	{"gps outliers", true, false, 1.0, 0.1},
+	{"distance", false, true, 0, 0, 0.05},
+	{"gps+distance", true, true, 1.0, 0.05, 0.05},
+	// The most --particles finds fits the tick budget.
+	{"particles", false, true, 0, 0, 0.05, 1024},
+	{"gps reverse", true, false, 1.0, 0, 0, 0, true},
+	{"dist reverse", false, true, 0, 0, 0.05, 0, true},
+};
+
+class Pusher : public sim::Plant {
+	sim::Drivetrain& drive;
+	std::uint32_t elapsed = 0;
+public:
+	Pusher(sim::Drivetrain& idrive) : drive(idrive) {
+	}
+
+	void step(sim::World&, double) override {
+		elapsed++;
+		drive.external_force = 0;
+		for (auto& shove : SHOVES) {
+			if (elapsed >= shove.time && elapsed < shove.time + shove.duration) {
+				drive.external_force = shove.force;
+			}
+		}
+	}
+};
+
+struct Errors {
+	double final = 0;   // cm
+	double mean = 0;    // cm
+	double max = 0;     // cm
+};
+
+struct Outcome {
+	Errors odom;
+	Errors localized;
+	std::uint32_t accepted = 0;
+	std::uint32_t rejected = 0;
+	double step = 0;    // cm, largest correction made in one Odom cycle
+};
+
+// Odom pose on the field, the way the Localizer maps it.
+static sim::Placement on_field(Odom& odom) {
+	auto position = odom.position();
+	double s = std::sin(START.heading * DEGREE_TO_RADIAN);
+	double c = std::cos(START.heading * DEGREE_TO_RADIAN);
+	return {START.x + position.x * s + position.y * c, START.y + position.x * c - position.y * s, 0};
+}
+
+static Outcome run(const Scenario& scenario, std::uint32_t duration) {
+	sim::World world;
+	auto config = sim::hbot_drive();
+	config.tracking_diameter *= TRACKING_SCALE;
+	auto& drive = sim::hbot_world(world, config);
+	world.attach<Pusher>(drive);
+
+	sim::FieldConfig field_config;
+	field_config.start = START;
+	if (scenario.gps) {
+		field_config.gps = GPS_PORT;
+		field_config.gps_noise = scenario.gps_noise;
+		field_config.gps_outliers = scenario.gps_outliers;
+	}
+	if (scenario.distances) {
+		field_config.distances = DISTANCES;
+		field_config.distance_outliers = scenario.distance_outliers;
+	}
+	field_config.obstacles = {OBSTACLE};
+	auto& field = world.attach<sim::FieldSensors>(world, drive, field_config);
+
+	Outcome outcome;
+	std::unique_ptr<Chassis> chassis;
+	std::unique_ptr<Odom> plain, localized;
+
+	std::uint32_t samples = 0;
+	sim::Placement last_plain{}, last_localized{};
+
+	auto measure = [&] {
+		auto truth = field.placement();
+		samples++;
+		for (auto* odom : {plain.get(), localized.get()}) {
+			auto& errors = odom == plain.get() ? outcome.odom : outcome.localized;
+			auto estimate = on_field(*odom);
+			double error = std::hypot(estimate.x - truth.x, estimate.y - truth.y);
+			errors.final = error;
+			errors.mean += (error - errors.mean) / samples;
+			errors.max = std::max(errors.max, error);
+		}
+
+		// Both read the same wheels, so where they move apart is the correction.
+		auto now_plain = on_field(*plain);
+		auto now_localized = on_field(*localized);
+		outcome.step = std::max(outcome.step, std::hypot(now_localized.x - last_localized.x - (now_plain.x - last_plain.x),
+		                                                 now_localized.y - last_localized.y - (now_plain.y - last_plain.y)));
+		last_plain = now_plain;
+		last_localized = now_localized;
+	};
+
+	world.run([&] {
+		chassis = Chassis::create({19, -17, -18}, {-12, 11, 13}, 11.5 * INCH_TO_CM);
+		plain = Odom::create(pros::Rotation(8), pros::Rotation(6, true), 2.75 * INCH_TO_CM, 5.25 * INCH_TO_CM, 10);
+		localized = Odom::create(pros::Rotation(8), pros::Rotation(6, true), 2.75 * INCH_TO_CM, 5.25 * INCH_TO_CM, 10);
+
+		auto map = FieldMap::walls().add_polygon(OBSTACLE);
+		auto localizer = Localizer::create(map, START.x, START.y, START.heading);
+		if (scenario.gps) {
+			localizer->add_gps(pros::Gps(GPS_PORT));
+		}
+		if (scenario.distances && scenario.particles > 0) {
+			auto particles = ParticleFilter::create(map, scenario.particles, START.x, START.y, START.heading);
+			for (auto& mount : DISTANCES) {
+				particles->add_distance(pros::Distance(mount.port), mount.forward, mount.right, mount.angle);
+			}
+			localizer->add_particles(std::move(particles));
+		} else if (scenario.distances) {
+			for (auto& mount : DISTANCES) {
+				localizer->add_distance(pros::Distance(mount.port), mount.forward, mount.right, mount.angle);
+			}
+		}
+		localized->localize(std::move(localizer));
+
+		pros::delay(20);
+		last_plain = on_field(*plain);
+		last_localized = on_field(*localized);
+
+		std::size_t corner = 0;
+		for (std::uint32_t t = 0; t < duration; t += 10) {
+			auto truth = field.placement();
+			double dx = CORNERS[corner].first - truth.x;
+			double dy = CORNERS[corner].second - truth.y;
+			if (std::hypot(dx, dy) < 15) {
+				corner = (corner + 1) % CORNERS.size();
+			}
+			// Backwards, the back of the robot is what points at the corner.
+			double facing = truth.heading * DEGREE_TO_RADIAN + (scenario.reverse ? M_PI : 0);
+			double error = std::remainder(std::atan2(dx, dy) - facing, 2 * M_PI);
+			double turn = std::clamp(error * 8000, -6000.0, 6000.0);
+			double power = (scenario.reverse ? -6000 : 6000) * std::max(0.0, std::cos(error));
+			chassis->move_voltage(power, turn);
+
+			pros::delay(10);
+			measure();
+			}
+		chassis->stop();
+		for (int t = 0; t < 500; t += 10) {
+			pros::delay(10);
+			measure();
+		}
+
+		auto* active = localized->get_localizer();
+		outcome.accepted = active->accepted();
+		outcome.rejected = active->rejected();
+	});
+	return outcome;
+}
+
+// The Localizer has to hold the pose where plain Odom drifts, and never move
+// it by more than a centimetre in one cycle.
+static bool check(const Scenario& scenario, const Outcome& outcome) {
+	double bound = scenario.gps_noise > 2 ? 8 : 5;
+	double step = 1;
+	return outcome.localized.final < bound && outcome.localized.mean < outcome.odom.mean / 3 &&
+	       outcome.step < step && (scenario.gps_outliers == 0 || outcome.rejected > 0);
+}
+
+// Host time for one ParticleFilter update with every sensor reading, in us,
+// taken as the best of several batches so other load on the host drops out.
+static double time_update(std::size_t count) {
+	sim::World world;
+	auto& drive = sim::hbot_world(world);
+	sim::FieldConfig field_config;
+	field_config.start = START;
+	field_config.distances = DISTANCES;
+	field_config.obstacles = {OBSTACLE};
+	world.attach<sim::FieldSensors>(world, drive, field_config);
+
+	double best = INFINITY;
+	world.run([&] {
+		auto particles = ParticleFilter::create(FieldMap::walls().add_polygon(OBSTACLE), count, START.x, START.y,
+		                                        START.heading);
+		for (auto& mount : DISTANCES) {
+			particles->add_distance(pros::Distance(mount.port), mount.forward, mount.right, mount.angle);
+		}
+		pros::delay(100);
+
+		constexpr int BATCH = 200;
+		for (int batch = 0; batch < 5; batch++) {
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < BATCH; i++) {
+				particles->move(0.5, 0, 0.001);
+				particles->update();
+			}
+			std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+			best = std::min(best, elapsed.count() / BATCH);
+		}
+	});
+	return best;
+}
+
+// Share of an Odom period the tick that runs a particle update may take on
+// the V5, leaving the rest for Odom itself and the tasks it shares the brain with.
+constexpr double TICK_BUDGET = 0.25;
+constexpr double ODOM_PERIOD = 10;  // ms, as initialize() sets it
+
+static int bench(const std::vector<std::size_t>& counts, std::uint32_t duration, double slowdown) {
+	// The whole update runs inside the one Odom tick that reaches
+	// UPDATE_INTERVAL, so that tick carries its full cost.
+	std::printf("update every %.0f ms inside one %.0f ms Odom tick, %zu distance sensors, %zu map segments, "
+	            "V5 taken as %gx slower than this host\n\n",
+	            Localizer::UPDATE_INTERVAL * 1000, ODOM_PERIOD, DISTANCES.size(),
+	            FieldMap::walls().add_polygon(OBSTACLE).segments.size(), slowdown);
+	std::printf("%9s %11s %11s %11s %9s %9s\n", "particles", "us/update", "V5 ms", "V5 tick %", "mean cm",
+	            "final cm");
+	std::size_t chosen = 0;
+	for (auto count : counts) {
+		double cost = time_update(count);
+		double v5 = cost * slowdown / 1000;
+		double share = v5 / ODOM_PERIOD;
+		Scenario scenario{"particles", false, true, 0, 0, 0.05, count};
+		auto outcome = run(scenario, duration);
+		std::printf("%9zu %11.1f %11.2f %11.1f %9.1f %9.1f\n", count, cost, v5, share * 100,
+		            outcome.localized.mean, outcome.localized.final);
+		if (share <= TICK_BUDGET) {
+			chosen = std::max(chosen, count);
+		}
+	}
+	if (chosen > 0) {
+		std::printf("\nlargest count whose update tick fits in %.0f%% of the period: %zu\n", TICK_BUDGET * 100, chosen);
+	} else {
+		std::printf("\nno count's update tick fits in %.0f%% of the period\n", TICK_BUDGET * 100);
+	}
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	std::uint32_t duration = 45000;
+	std::vector<std::size_t> counts;
+	double slowdown = 20;
+	for (int i = 1; i < argc; i++) {
+		if (!std::strcmp(argv[i], "--time") && i + 1 < argc) {
+			duration = std::max(1000, std::atoi(argv[++i]));
+		} else if (!std::strcmp(argv[i], "--particles") && i + 1 < argc) {
+			for (char* count = std::strtok(argv[++i], ","); count != nullptr; count = std::strtok(nullptr, ",")) {
+				counts.push_back(std::clamp<std::size_t>(std::atoi(count), 1, ParticleFilter::MAX_PARTICLES));
+			}
+		} else if (!std::strcmp(argv[i], "--slowdown") && i + 1 < argc) {
+			slowdown = std::atof(argv[++i]);
+		} else {
+			std::fprintf(stderr, "usage: %s [--time ms] [--particles n,n,...] [--slowdown k]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (!counts.empty()) {
+		return bench(counts, duration, slowdown);
+	}
+
+	std::printf("%-13s %-19s %-29s\n", "", "odom only", "localized");
+	std::printf("%-13s %9s %9s %9s %9s %9s %9s %9s %9s %s\n", "scenario", "final cm", "mean cm", "final cm",
+	            "mean cm", "max cm", "step cm", "accepted", "rejected", "check");
+
+	bool passed = true;
+	for (auto& scenario : SCENARIOS) {
+		auto outcome = run(scenario, duration);
+		bool ok = check(scenario, outcome);
+		passed &= ok;
+		std::printf("%-13s %9.1f %9.1f %9.1f %9.1f %9.1f %9.2f %9u %9u %s\n", scenario.name, outcome.odom.final,
+		            outcome.odom.mean, outcome.localized.final, outcome.localized.mean, outcome.localized.max,
+		            outcome.step, outcome.accepted, outcome.rejected, ok ? "ok" : "FAILED");
+	}
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,43 @@
+#include "robot.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+int main(int argc, char** argv) {
+	std::string name = argc > 1 ? argv[1] : "left";
+	const sim::Routine* routine = nullptr;
+	for (auto& candidate : sim::hbot_routines()) {
+		if (name == candidate.name) {
+			routine = &candidate;
+		}
+	}
+	if (routine == nullptr) {
+		std::fprintf(stderr, "usage: %s [left|right|solo|skills] [--lcd]\n", argv[0]);
+		return 2;
+	}
+
+	sim::World world;
+	world.lcd_echo = argc > 2 && std::strcmp(argv[2], "--lcd") == 0;
+	auto& drive = sim::hbot_world(world);
+
+	auto start = std::chrono::steady_clock::now();
+	bool finished = world.run([&] {
+		initialize();
+		routine->function();
+	}, routine->timeout);
+	auto odom = robot->controllers->odom->position();
+	double jitter = robot->controllers->odom->jitter();
+	double max_jitter = robot->controllers->odom->max_jitter();
+	auto wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::printf("routine:  auto_%s (%s)\n", routine->name, finished ? "finished" : "timed out");
+	std::printf("time:     %u ms simulated, %.1f ms wall\n", world.millis(), wall);
+	std::printf("pose:     x %.2f cm, y %.2f cm, heading %.2f deg\n",
+	            drive.pose.x, drive.pose.y, drive.pose.theta * RADIAN_TO_DEGREE);
+	std::printf("odom:     x %.2f cm, y %.2f cm, heading %.2f deg\n", odom.x, odom.y, odom.heading);
+	std::printf("jitter:   %.3f ms mean, %.3f ms worst\n", jitter, max_jitter);
+
+	robot.reset();
+	return finished ? 0 : 1;
+}
@@ -0,0 +1,358 @@
+#include "robot.hpp"
+#include "trajectories.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+// Runs each path two ways from initialize(): as the stop-turn-drive chain the
+// autons use today and with a newer motion, and reports how long each took
+// and how far from the goal the robot really stopped. The run fails if a
+// motion takes longer or stops further off than its case's bound.
+
+struct Goal {
+	double x;        // cm in Odom's frame
+	double y;
+	double heading;  // degrees, NAN when the path does not care
+};
+
+// Worst the motion may do: set a little past what it does now, so a change
+// that slows it or leaves it further off fails the run.
+struct Bound {
+	std::uint32_t time;  // ms
+	double error;        // cm from the goal
+	double heading;      // degrees either way, NAN when the path does not care
+};
+
+struct Case {
+	const char* name;
+	const char* with;  // the motion that replaces the chain
+	std::function<void()> chain;
+	std::function<void()> motion;
+	Goal goal;
+	Bound bound;
+};
+
+static const std::vector<Case>& cases() {
+	static const std::vector<Case> all = {
+		{"zigzag", "follow_path",
+		 [] {
+			 robot->drive_to_point(60, 0);
+			 robot->drive_to_point(100, 40);
+			 robot->drive_to_point(160, 40);
+			 robot->drive_to_point(200, 0);
+		 },
+		 [] { robot->follow_path({{60, 0}, {100, 40}, {160, 40}, {200, 0}}); },
+		 {200, 0, NAN}, {4800, 4, NAN}},
+		{"loop", "follow_path",
+		 [] {
+			 robot->drive_to_point(80, 0);
+			 robot->drive_to_point(120, -60);
+			 robot->drive_to_point(60, -120);
+			 robot->drive_to_point(0, -120);
+		 },
+		 [] { robot->follow_path({{80, 0}, {120, -60}, {60, -120}, {0, -120}}); },
+		 {0, -120, NAN}, {5500, 3, NAN}},
+		{"reverse", "follow_path",
+		 [] {
+			 robot->drive_to_point(-70, 0, true);
+			 robot->drive_to_point(-110, 50, true);
+			 robot->drive_to_point(-110, 110, true);
+		 },
+		 [] { robot->follow_path({{-70, 0}, {-110, 50}, {-110, 110}}, true); },
+		 {-110, 110, NAN}, {3700, 4, NAN}},
+		{"s-curve", "trajectory",
+		 [] {
+			 robot->drive_to_point(70, 35);
+			 robot->drive_to_point(140, 0);
+			 robot->turn_to_angle(0);
+		 },
+		 [] { robot->follow_trajectory(robot->generate_trajectory({{0, 0, 0}, {70, 35, 0}, {140, 0, 0}})); },
+		 {140, 0, 0}, {2350, 3, 3}},
+		// Shaped like auto_right's leg from the roller back into the line of three.
+		{"back arc", "trajectory",
+		 [] {
+			 robot->drive_to_point(-60, -100, true);
+			 robot->turn_to_angle(90);
+		 },
+		 [] {
+			 robot->follow_trajectory(robot->generate_trajectory({{0, 0, 0}, {-60, -100, M_PI / 2}}, true), true);
+		 },
+		 {-60, -100, 90}, {1900, 4, 4}},
+		{"back table", "table",
+		 [] {
+			 robot->drive_to_point(-60, -100, true);
+			 robot->turn_to_angle(90);
+		 },
+		 [] { robot->follow_trajectory(trajectories::BACK_ARC); },
+		 {-60, -100, 90}, {1900, 4, 4}},
+		// Skills drives in legs like these, stopping at the end of each.
+		{"legs", "chained",
+		 [] {
+			 robot->drive_dist(60);
+			 robot->drive_dist(50);
+			 robot->drive_dist(70);
+		 },
+		 [] {
+			 robot->drive_dist_chained(60);
+			 robot->drive_dist_chained(50);
+			 robot->drive_dist(70);
+		 },
+		 {180, 0, NAN}, {2450, 5, NAN}},
+		{"waypoints", "chained",
+		 [] {
+			 robot->drive_to_point(60, 0);
+			 robot->drive_to_point(100, 40);
+			 robot->drive_to_point(160, 40);
+			 robot->drive_to_point(200, 0);
+		 },
+		 [] {
+			 robot->drive_to_point_chained(60, 0);
+			 robot->drive_to_point_chained(100, 40);
+			 robot->drive_to_point_chained(160, 40);
+			 robot->drive_to_point(200, 0);
+		 },
+		 {200, 0, NAN}, {6000, 4, NAN}},
+		{"sweep", "chained",
+		 [] {
+			 robot->turn_to_angle(90);
+			 robot->turn_to_angle(180);
+		 },
+		 [] {
+			 robot->turn_to_angle_chained(90);
+			 robot->turn_to_angle(180);
+		 },
+		 {0, 0, 180}, {1300, 2, 2}},
+		{"straight", "profiled",
+		 [] { robot->drive_dist(120); },
+		 [] { robot->drive_dist_profiled(120); },
+		 {120, 0, 0}, {1500, 2, 2}},
+		// Slower than the PID's lunge at this length, which lands further off.
+		{"hop", "profiled",
+		 [] { robot->drive_dist(25); },
+		 [] { robot->drive_dist_profiled(25); },
+		 {25, 0, 0}, {800, 2, 2}},
+		// The autons cap the voltage to keep the robot from wheelieing.
+		{"capped", "profiled",
+		 [] {
+			 robot->chassis->set_voltage_percent(50);
+			 robot->drive_dist(-75);
+			 robot->chassis->set_voltage_percent(100);
+		 },
+		 [] { robot->drive_dist_profiled(-75); },
+		 {-75, 0, 0}, {1200, 2, 2}},
+		{"quarter", "profiled",
+		 [] { robot->turn_to_angle(90); },
+		 [] { robot->turn_to_angle_profiled(90); },
+		 {0, 0, 90}, {750, 2, 2}},
+		{"wide", "profiled",
+		 [] { robot->turn_to_angle(-150); },
+		 [] { robot->turn_to_angle_profiled(-150); },
+		 {0, 0, -150}, {850, 2, 2}},
+		{"nudge", "profiled",
+		 [] { robot->turn_to_angle(-15); },
+		 [] { robot->turn_to_angle_profiled(-15); },
+		 {0, 0, -15}, {500, 2, 2}},
+		// Coming out of a chained turn spinning away from the short way round.
+		{"about", "fastest",
+		 [] {
+			 robot->turn_to_angle_chained(120, 30);
+			 robot->turn_to_angle(-75);
+		 },
+		 [] {
+			 robot->turn_to_angle_chained(120, 30);
+			 robot->turn_to_angle_profiled(-75, true);
+		 },
+		 {0, 0, -75}, {1300, 2, 2}},
+		// Starting the intake partway along a drive instead of between two.
+		{"pickup", "async",
+		 [] {
+			 robot->drive_dist(60);
+			 robot->intake->move_voltage(12000);
+			 robot->drive_dist(60);
+		 },
+		 [] {
+			 auto motion = robot->drive_dist_async(120);
+			 motion.wait_until_dist(60);
+			 robot->intake->move_voltage(12000);
+			 motion.wait();
+		 },
+		 {120, 0, NAN}, {1750, 3, NAN}},
+		// Every shot in auto_left and auto_right: drive in, then turn to aim.
+		{"shot", "move_to_pose",
+		 [] {
+			 robot->drive_to_point(90, 70);
+			 robot->turn_to_angle(-30);
+		 },
+		 [] { robot->move_to_pose(90, 70, -30); },
+		 {90, 70, -30}, {2650, 3, 2}},
+		{"back shot", "move_to_pose",
+		 [] {
+			 robot->drive_to_point(-80, -50, true);
+			 robot->turn_to_angle(20);
+		 },
+		 [] { robot->move_to_pose(-80, -50, 20, true); },
+		 {-80, -50, 20}, {2100, 3, 2}},
+	};
+	return all;
+}
+
+struct Result {
+	std::uint32_t time;  // ms
+	double error;        // cm from the goal, true pose
+	double heading;      // degrees from the goal heading, true pose
+	bool finished;
+};
+
+static Result run(const std::function<void()>& motion, const Goal& goal) {
+	sim::World world;
+	auto& drive = sim::hbot_world(world);
+	Result result{};
+	result.finished = world.run([&] {
+		initialize();
+		pros::delay(100);
+		std::uint32_t start = pros::millis();
+		motion();
+		result.time = pros::millis() - start;
+	}, 30000);
+
+	result.error = std::hypot(drive.pose.x - goal.x, drive.pose.y - goal.y);
+	result.heading = std::isnan(goal.heading)
+		? NAN
+		: std::remainder(drive.pose.theta * RADIAN_TO_DEGREE - goal.heading, 360.0);
+	robot.reset();
+	return result;
+}
+
+// The feedforward the drivetrain model works out to while driving straight
+// without slipping: each side's motors against rolling resistance, viscous
+// drag and half the robot's mass plus the gearbox's, per the model's DriveConfig.
+static Feedforward plant_feedforward(const sim::DriveConfig& config) {
+	sim::Motor motor;
+	motor.cartridge = config.cartridge;
+	double radius = config.wheel_diameter / 200.0;
+	double force = config.left.size() * motor.stall_torque() / config.gear_ratio / radius;  // N at the tread, stalled at 12 V
+	double per_mv = force / 12000;
+	double back_emf = force * 60 / (2 * M_PI * radius * config.gear_ratio) / motor.free_rpm();  // N per m/s
+	double load = config.mass * sim::Drivetrain::GRAVITY / 2;
+	return Feedforward(config.rolling_resistance * load / per_mv, (config.viscous_drag + back_emf) / per_mv / 100,
+	                   (config.wheel_mass + config.mass / 2) / per_mv / 100);
+}
+
+// Runs Robot::characterize from initialize() and compares its fit with the
+// model's. Friction is the hardest to see and gets the widest margin.
+static bool check_characterize() {
+	sim::World world;
+	auto& drive = sim::hbot_world(world);
+	std::unique_ptr<Feedforward> fit;
+	bool finished = world.run([&] {
+		initialize();
+		pros::delay(100);
+		fit = robot->characterize();
+	}, 60000);
+	robot.reset();
+
+	auto plant = plant_feedforward(drive.config);
+	if (!finished || !fit) {
+		std::printf("%-10s did not %s: FAIL\n", "characterize", finished ? "fit" : "finish");
+		return false;
+	}
+	double ks = fit->get_ks() / plant.get_ks() - 1;
+	double kv = fit->get_kv() / plant.get_kv() - 1;
+	double ka = fit->get_ka() / plant.get_ka() - 1;
+	bool ok = std::abs(ks) < 0.15 && std::abs(kv) < 0.05 && std::abs(ka) < 0.2;
+	std::printf("%-10s ks %.0f (%.0f, %+.0f%%) kv %.1f (%.1f, %+.0f%%) ka %.1f (%.1f, %+.0f%%): %s\n", "characterize",
+	            fit->get_ks(), plant.get_ks(), ks * 100, fit->get_kv(), plant.get_kv(), kv * 100, fit->get_ka(),
+	            plant.get_ka(), ka * 100, ok ? "ok" : "FAIL");
+	return ok;
+}
+
+// Has the chassis task hold each speed pair with hold_velocity for three
+// seconds, and reports when the robot's true speed last left the band and
+// its worst error over the final second. Turning comes in slowly: the
+// per-side loops do not model the scrub, so their integrals make it up.
+static bool check_velocity() {
+	struct Hold {
+		double linear;   // cm/s
+		double angular;  // rad/s
+	};
+	const Hold holds[] = {{60, 0}, {-90, 0}, {40, 1}, {0, -2}};
+	const double LINEAR_BAND = 3;     // cm/s
+	const double ANGULAR_BAND = 0.1;  // rad/s
+
+	bool all = true;
+	for (auto& hold : holds) {
+		sim::World world;
+		auto& drive = sim::hbot_world(world);
+		double linear = 0, angular = 0, left_over = 0;
+		std::uint32_t settled = 0;
+		world.run([&] {
+			initialize();
+			pros::delay(100);
+			robot->hold_velocity(hold.linear, hold.angular);
+			for (std::uint32_t t = 0; t < 3000; t++) {
+				double linear_error = std::abs(drive.velocity * 100 - hold.linear);
+				double angular_error = std::abs(drive.angular_velocity - hold.angular);
+				if (linear_error > LINEAR_BAND || angular_error > ANGULAR_BAND) {
+					settled = t + 1;
+				}
+				if (t >= 2000) {
+					linear = std::max(linear, linear_error);
+					angular = std::max(angular, angular_error);
+				}
+				pros::delay(1);
+			}
+			robot->cancel();
+			// The chassis must stay stopped once cancel() returns. The sim
+			// never switches tasks mid-step, so this cannot catch the hold
+			// step racing cancel(); loop() guards that with running.
+			pros::delay(50);
+			for (auto& ports : {drive.config.left, drive.config.right}) {
+				for (auto port : ports) {
+					left_over = std::max(left_over, std::abs(world.motor(port).target));
+				}
+			}
+		}, 5000);
+		robot.reset();
+
+		bool ok = linear < LINEAR_BAND && angular < ANGULAR_BAND && left_over == 0;
+		std::printf("%-10s %+.0f cm/s %+.1f rad/s in band after %u ms, then within %.2f cm/s and %.3f rad/s, %.0f mV after cancel: %s\n",
+		            "velocity", hold.linear, hold.angular, settled, linear, angular, left_over, ok ? "ok" : "FAIL");
+		all = all && ok;
+	}
+	return all;
+}
+
+int main(int argc, char** argv) {
+	const char* only = argc > 1 ? argv[1] : nullptr;
+
+	std::printf("%-10s %-29s %-29s\n", "", "turn and drive chain", "motion");
+	std::printf("%-10s %9s %9s %9s %9s %9s %9s %9s  %-13s %s\n", "case", "ms", "cm", "deg", "ms", "cm", "deg", "saved ms",
+	            "with", "check");
+	bool ok = true;
+	for (auto& c : cases()) {
+		if (only != nullptr && std::strcmp(only, c.name) != 0) {
+			continue;
+		}
+		auto chain = run(c.chain, c.goal);
+		auto motion = run(c.motion, c.goal);
+		bool within = motion.finished && motion.time <= c.bound.time && motion.error <= c.bound.error &&
+		              (std::isnan(c.bound.heading) || std::abs(motion.heading) <= c.bound.heading);
+		ok = ok && within;
+		std::printf("%-10s %9u %9.1f %9.1f %9u %9.1f %9.1f %9d  %-13s %s%s\n", c.name, chain.time, chain.error,
+		            chain.heading, motion.time, motion.error, motion.heading,
+		            static_cast<int>(chain.time) - static_cast<int>(motion.time), c.with, within ? "ok" : "FAIL",
+		            chain.finished && motion.finished ? "" : " [timed out]");
+	}
+
+	if (only == nullptr || !std::strcmp(only, "characterize") || !std::strcmp(only, "velocity")) {
+		std::printf("\n");
+	}
+	if (only == nullptr || !std::strcmp(only, "characterize")) {
+		ok = check_characterize() && ok;
+	}
+	if (only == nullptr || !std::strcmp(only, "velocity")) {
+		ok = check_velocity() && ok;
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,221 @@
+#include "robot.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// Drives a fixed open-loop path with a two-wheel Odom, an IMU-fused Odom and a
+// three-wheel Odom reading the same sensors, under injected tracking wheel
+// slip, sideways shoves, gyro drift and IMU faults. Checks that fusion keeps
+// the heading where the wheels lose it and falls back when the IMU goes bad,
+// and that the back wheel catches shoves the other two never see.
+
+constexpr std::uint8_t IMU_PORT = 7;
+constexpr std::uint8_t BACK_PORT = 5;
+constexpr double BACK_OFFSET = 10;  // cm behind the tracking centre
+
+struct Segment {
+	std::uint32_t duration;  // ms
+	double power;            // mV
+	double turn;             // mV
+};
+
+// One lap; the scenario repeats it. The stops give the filter still time to
+// learn the gyro bias.
+const std::vector<Segment> LAP = {
+	{1500, 6000, 0},
+	{500, 0, 0},
+	{900, 0, 5000},
+	{700, 0, 0},
+	{2000, 6000, 2500},
+	{400, 0, 0},
+	{1200, -5000, 0},
+	{800, 0, -6000},
+	{1000, 0, 0},
+};
+
+struct Bump {
+	std::uint32_t time;      // ms
+	double torque;           // N*m clockwise
+	std::uint32_t duration;  // ms the robot is shoved with its tracking wheels off the ground
+};
+
+struct Shove {
+	std::uint32_t time;      // ms
+	double force;            // N to the robot's right
+	std::uint32_t duration;  // ms
+};
+
+struct Scenario {
+	const char* name;
+	std::vector<Bump> bumps;
+	std::vector<Shove> shoves;
+	double drift = 0;        // gyro bias, deg/s
+	double scale = 1;        // gyro scale factor
+	std::uint32_t unplug = 0;    // ms the IMU is pulled out, 0 for never
+	std::uint32_t fault = 0;     // ms the gyro bias jumps to fault_drift, 0 for never
+	double fault_drift = 0;
+};
+
+const std::vector<Bump> BUMPS = {{5200, 3.0, 150}, {13700, -3.5, 150}, {22300, 2.5, 200}, {31000, -3.0, 150}};
+
+const std::vector<Shove> SHOVES = {{3300, 150, 300}, {11000, -200, 250}, {19800, 150, 400}, {29000, -180, 300}};
+
+const std::vector<Scenario> SCENARIOS = {
+	{"nominal", {}, {}},
+	{"drift", {}, {}, 0.3, 1.01},
+	{"bumps", BUMPS, {}},
+	{"bumps+drift", BUMPS, {}, 0.3, 1.01},
+	{"shoved", {}, SHOVES},
+	{"unplugged", BUMPS, {}, 0, 1, 15000},
+	{"bad gyro", {}, {}, 0, 1, 0, 12000, 25},
+};
+
+// Applies a scenario's disturbances as the clock reaches them.
+class Disturbance : public sim::Plant {
+	const Scenario& scenario;
+	sim::Drivetrain& drive;
+	std::uint32_t elapsed = 0;
+public:
+	Disturbance(const Scenario& iscenario, sim::Drivetrain& idrive) : scenario(iscenario), drive(idrive) {
+	}
+
+	void step(sim::World& world, double) override {
+		elapsed++;
+		drive.external_torque = 0;
+		drive.external_force = 0;
+		drive.tracking_contact = true;
+		for (auto& bump : scenario.bumps) {
+			if (elapsed >= bump.time && elapsed < bump.time + bump.duration) {
+				drive.external_torque = bump.torque;
+				drive.tracking_contact = false;
+			}
+		}
+		for (auto& shove : scenario.shoves) {
+			if (elapsed >= shove.time && elapsed < shove.time + shove.duration) {
+				drive.external_force = shove.force;
+			}
+		}
+
+		auto& imu = world.imu(IMU_PORT);
+		if (scenario.unplug != 0 && elapsed == scenario.unplug) {
+			imu.present = false;
+		}
+		if (scenario.fault != 0 && elapsed == scenario.fault) {
+			imu.drift = scenario.fault_drift;
+		}
+	}
+};
+
+struct Errors {
+	double final_heading = 0;  // deg
+	double max_heading = 0;    // deg
+	double position = 0;       // cm at the end
+};
+
+struct Outcome {
+	Errors wheels;
+	Errors fused;
+	Errors three;
+	bool fusing;               // IMU still in use at the end
+};
+
+static Outcome run(const Scenario& scenario, int laps) {
+	sim::World world;
+	auto config = sim::hbot_drive();
+	config.imu = IMU_PORT;
+	config.back_sensor = BACK_PORT;
+	config.back_offset = BACK_OFFSET;
+	auto& drive = sim::hbot_world(world, config);
+	auto& imu = world.imu(IMU_PORT);
+	imu.drift = scenario.drift;
+	imu.scale = scenario.scale;
+	world.attach<Disturbance>(scenario, drive);
+
+	Outcome outcome{};
+	std::unique_ptr<Chassis> chassis;
+	std::unique_ptr<Odom> wheels, fused, three;
+
+	auto measure = [&](Odom& odom, Errors& errors) {
+		double heading = (odom.raw_heading(true) - drive.pose.theta) * RADIAN_TO_DEGREE;
+		auto position = odom.position();
+		errors.final_heading = heading;
+		errors.max_heading = std::max(errors.max_heading, std::abs(heading));
+		errors.position = std::hypot(position.x - drive.pose.x, position.y - drive.pose.y);
+	};
+
+	world.run([&] {
+		chassis = Chassis::create({19, -17, -18}, {-12, 11, 13}, 11.5 * INCH_TO_CM);
+		wheels = Odom::create(pros::Rotation(8), pros::Rotation(6, true), 2.75 * INCH_TO_CM, 5.25 * INCH_TO_CM, 10);
+		fused = Odom::create(pros::Rotation(8), pros::Rotation(6, true), pros::Imu(IMU_PORT), 2.75 * INCH_TO_CM,
+		                     5.25 * INCH_TO_CM, 10);
+		three = Odom::create(pros::Rotation(8), pros::Rotation(6, true), pros::Rotation(BACK_PORT), 2.75 * INCH_TO_CM,
+		                     5.25 * INCH_TO_CM, BACK_OFFSET, 10);
+
+		// The IMU calibrates for two seconds with the robot still.
+		pros::delay(2500);
+		for (int lap = 0; lap < laps; lap++) {
+			for (auto& segment : LAP) {
+				chassis->move_voltage(segment.power, segment.turn);
+				for (std::uint32_t t = 0; t < segment.duration; t += 10) {
+					pros::delay(10);
+					measure(*wheels, outcome.wheels);
+					measure(*fused, outcome.fused);
+					measure(*three, outcome.three);
+				}
+			}
+		}
+		chassis->stop();
+		pros::delay(500);
+		measure(*wheels, outcome.wheels);
+		measure(*fused, outcome.fused);
+		measure(*three, outcome.three);
+		outcome.fusing = fused->fused();
+	});
+	return outcome;
+}
+
+// What each scenario has to show.
+static bool check(const Scenario& scenario, const Outcome& outcome) {
+	double wheels = std::abs(outcome.wheels.final_heading);
+	double fused = std::abs(outcome.fused.final_heading);
+	if (scenario.fault != 0) {
+		return !outcome.fusing && fused < wheels + 2;
+	}
+	if (scenario.unplug != 0) {
+		return !outcome.fusing && fused <= wheels + 0.5;
+	}
+	if (!scenario.shoves.empty()) {
+		return outcome.three.position < 5 && outcome.three.position < outcome.wheels.position / 4;
+	}
+	if (!scenario.bumps.empty()) {
+		return outcome.fusing && fused < 2 && fused < wheels;
+	}
+	return outcome.fusing && fused < 1 && outcome.fused.max_heading < outcome.wheels.max_heading + 0.5;
+}
+
+int main(int argc, char** argv) {
+	int laps = 4;
+	if (argc > 2 && !std::strcmp(argv[1], "--laps")) {
+		laps = std::max(1, std::atoi(argv[2]));
+	} else if (argc > 1) {
+		std::fprintf(stderr, "usage: %s [--laps n]\n", argv[0]);
+		return 2;
+	}
+
+	std::printf("%-12s %-29s %-29s %-29s\n", "", "two wheels", "two wheels + IMU", "three wheels");
+	std::printf("%-12s %9s %9s %9s %9s %9s %9s %9s %9s %9s %-8s %s\n", "scenario", "final deg", "max deg", "pos cm",
+	            "final deg", "max deg", "pos cm", "final deg", "max deg", "pos cm", "imu", "check");
+
+	bool passed = true;
+	for (auto& scenario : SCENARIOS) {
+		auto outcome = run(scenario, laps);
+		bool ok = check(scenario, outcome);
+		passed &= ok;
+		std::printf("%-12s", scenario.name);
+		for (auto* errors : {&outcome.wheels, &outcome.fused, &outcome.three}) {
+			std::printf(" %9.2f %9.2f %9.1f", errors->final_heading, errors->max_heading, errors->position);
+		}
+		std::printf(" %-8s %s\n", outcome.fusing ? "fused" : "dropped", ok ? "ok" : "FAILED");
+	}
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace sim {
+
+// Calls function(i) for every i below count, split across forked workers, and
+// returns the results in order. The robot code keeps its state in globals, so
+// each simulation needs its own process rather than its own thread. Workers
+// send stdout to /dev/null since the robot code logs freely.
+template <class Result, class Function>
+std::vector<Result> parallel_map(std::size_t count, unsigned jobs, Function function) {
+	static_assert(std::is_trivially_copyable_v<Result>, "results are sent back through a pipe");
+
+	struct Message {
+		std::size_t index;
+		Result result;
+	};
+
+	std::vector<int> pipes;
+	std::vector<pid_t> workers;
+
+	std::fflush(stdout);
+	for (unsigned worker = 0; worker < jobs && worker < count; worker++) {
+		int fds[2];
+		if (pipe(fds) != 0) {
+			std::perror("pipe");
+			std::exit(1);
+		}
+
+		pid_t pid = fork();
+		if (pid == 0) {
+			close(fds[0]);
+			if (std::freopen("/dev/null", "w", stdout) == nullptr) {
+				_exit(1);
+			}
+			for (std::size_t i = worker; i < count; i += jobs) {
+				Message message{i, function(i)};
+				if (write(fds[1], &message, sizeof(message)) != sizeof(message)) {
+					_exit(1);
+				}
+			}
+			_exit(0);
+		}
+
+		close(fds[1]);
+		pipes.push_back(fds[0]);
+		workers.push_back(pid);
+	}
+
+	std::vector<Result> results(count);
+	std::size_t received = 0;
+	for (int fd : pipes) {
+		Message message;
+		while (read(fd, &message, sizeof(message)) == sizeof(message)) {
+			results.at(message.index) = message.result;
+			received++;
+		}
+		close(fd);
+	}
+	for (pid_t pid : workers) {
+		waitpid(pid, nullptr, 0);
+	}
+
+	if (received != count) {
+		std::fprintf(stderr, "parallel_map: %zu of %zu results reported back\n", received, count);
+		std::exit(1);
+	}
+	return results;
+}
+
+}
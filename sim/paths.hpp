@@ -0,0 +1,20 @@
+#pragma once
+#include "hbot.hpp"
+#include <vector>
+
+// Paths that hbot_trajectories precompiles into trajectories.hpp. Poses are
+// in cm and radians in Odom's frame, the first one where the robot starts,
+// and with reverse the yaws are the way the robot faces as it backs along
+// the path. Run `make -C sim trajectories` after changing one.
+struct PathDefinition {
+	const char* name;
+	std::vector<squiggles::Pose> poses;
+	bool reverse = false;
+	double velocity = Robot::TRAJECTORY_VELOCITY;
+	double acceleration = Robot::TRAJECTORY_ACCELERATION;
+};
+
+inline const std::vector<PathDefinition> PATHS = {
+	{"S_CURVE", {{0, 0, 0}, {70, 35, 0}, {140, 0, 0}}},
+	{"BACK_ARC", {{0, 0, 0}, {-60, -100, M_PI / 2}}, true},
+};
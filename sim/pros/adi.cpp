@@ -0,0 +1,49 @@
+#include "sim.hpp"
+#include "pros/adi.hpp"
+
+namespace pros {
+
+ADIPort::ADIPort(std::uint8_t adi_port, adi_port_config_e_t) : _smart_port(INTERNAL_ADI_PORT), _adi_port(adi_port) {
+}
+
+ADIPort::ADIPort(ext_adi_port_pair_t port_pair, adi_port_config_e_t) :
+_smart_port(port_pair.first), _adi_port(port_pair.second) {
+}
+
+std::int32_t ADIPort::get_config() const {
+	return E_ADI_TYPE_UNDEFINED;
+}
+
+std::int32_t ADIPort::get_value() const {
+	return sim::world().adi_port(_adi_port);
+}
+
+std::int32_t ADIPort::set_config(adi_port_config_e_t) const {
+	return 1;
+}
+
+std::int32_t ADIPort::set_value(std::int32_t value) const {
+	sim::world().adi_port(_adi_port) = value;
+	return 1;
+}
+
+ADIDigitalOut::ADIDigitalOut(std::uint8_t adi_port, bool init_state) : ADIPort(adi_port, E_ADI_DIGITAL_OUT) {
+	set_value(init_state);
+}
+
+ADIDigitalOut::ADIDigitalOut(ext_adi_port_pair_t port_pair, bool init_state) :
+ADIPort(port_pair, E_ADI_DIGITAL_OUT) {
+	set_value(init_state);
+}
+
+ADIDigitalIn::ADIDigitalIn(std::uint8_t adi_port) : ADIPort(adi_port, E_ADI_DIGITAL_IN) {
+}
+
+ADIDigitalIn::ADIDigitalIn(ext_adi_port_pair_t port_pair) : ADIPort(port_pair, E_ADI_DIGITAL_IN) {
+}
+
+std::int32_t ADIDigitalIn::get_new_press() const {
+	return get_value();
+}
+
+}
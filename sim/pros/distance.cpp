@@ -0,0 +1,47 @@
+#include "sim.hpp"
+#include "pros/distance.hpp"
+#include <cerrno>
+
+namespace {
+
+inline sim::Distance* ready(std::uint8_t port) {
+	auto& distance = sim::world().distance(port);
+	if (!distance.present) {
+		errno = ENODEV;
+		return nullptr;
+	}
+	return &distance;
+}
+
+}
+
+namespace pros {
+
+Distance::Distance(const std::uint8_t port) : _port(port) {
+}
+
+std::int32_t Distance::get() {
+	auto* distance = ready(_port);
+	return distance == nullptr ? PROS_ERR : distance->range;
+}
+
+std::int32_t Distance::get_confidence() {
+	auto* distance = ready(_port);
+	return distance == nullptr ? PROS_ERR : distance->confidence;
+}
+
+std::int32_t Distance::get_object_size() {
+	auto* distance = ready(_port);
+	return distance == nullptr ? PROS_ERR : distance->size;
+}
+
+double Distance::get_object_velocity() {
+	auto* distance = ready(_port);
+	return distance == nullptr ? PROS_ERR_F : distance->velocity;
+}
+
+std::uint8_t Distance::get_port() {
+	return _port;
+}
+
+}
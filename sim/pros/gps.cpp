@@ -0,0 +1,138 @@
+#include "sim.hpp"
+#include "pros/gps.hpp"
+#include <cerrno>
+#include <cmath>
+
+namespace {
+
+// The sensor as a reader sees it, or nullptr with errno set when the port is
+// empty, which is when PROS returns PROS_ERR_F.
+inline sim::Gps* ready(std::uint8_t port) {
+	auto& gps = sim::world().gps(port);
+	if (!gps.present) {
+		errno = ENODEV;
+		return nullptr;
+	}
+	return &gps;
+}
+
+}
+
+namespace pros {
+namespace c {
+
+// The field plant reports the true pose, so setting the initial position only
+// checks the port.
+std::int32_t gps_set_position(std::uint8_t port, double, double, double) {
+	return ready(port) == nullptr ? PROS_ERR : 1;
+}
+
+std::int32_t gps_set_offset(std::uint8_t port, double xOffset, double yOffset) {
+	auto* gps = ready(port);
+	if (gps == nullptr) {
+		return PROS_ERR;
+	}
+	gps->offset_x = xOffset;
+	gps->offset_y = yOffset;
+	return 1;
+}
+
+std::int32_t gps_initialize_full(std::uint8_t port, double xInitial, double yInitial, double headingInitial,
+                                 double xOffset, double yOffset) {
+	if (gps_set_position(port, xInitial, yInitial, headingInitial) == PROS_ERR) {
+		return PROS_ERR;
+	}
+	return gps_set_offset(port, xOffset, yOffset);
+}
+
+}
+
+std::int32_t Gps::initialize_full(double xInitial, double yInitial, double headingInitial, double xOffset,
+                                  double yOffset) const {
+	return pros::c::gps_initialize_full(_port, xInitial, yInitial, headingInitial, xOffset, yOffset);
+}
+
+std::int32_t Gps::set_offset(double xOffset, double yOffset) const {
+	return pros::c::gps_set_offset(_port, xOffset, yOffset);
+}
+
+std::int32_t Gps::get_offset(double* xOffset, double* yOffset) const {
+	auto* gps = ready(_port);
+	if (gps == nullptr) {
+		return PROS_ERR;
+	}
+	*xOffset = gps->offset_x;
+	*yOffset = gps->offset_y;
+	return 1;
+}
+
+std::int32_t Gps::set_position(double xInitial, double yInitial, double headingInitial) const {
+	return pros::c::gps_set_position(_port, xInitial, yInitial, headingInitial);
+}
+
+std::int32_t Gps::set_data_rate(std::uint32_t rate) const {
+	sim::world().gps(_port).data_rate = rate;
+	return 1;
+}
+
+double Gps::get_error() const {
+	auto* gps = ready(_port);
+	return gps == nullptr ? PROS_ERR_F : gps->error;
+}
+
+pros::c::gps_status_s_t Gps::get_status() const {
+	auto* gps = ready(_port);
+	if (gps == nullptr) {
+		return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+	}
+	double yaw = std::remainder(gps->heading, 360.0);
+	return {gps->x, gps->y, 0, 0, yaw};
+}
+
+double Gps::get_heading() const {
+	auto* gps = ready(_port);
+	if (gps == nullptr) {
+		return PROS_ERR_F;
+	}
+	double heading = std::fmod(gps->heading, 360.0);
+	return heading < 0 ? heading + 360.0 : heading;
+}
+
+double Gps::get_heading_raw() const {
+	auto* gps = ready(_port);
+	return gps == nullptr ? PROS_ERR_F : gps->heading;
+}
+
+double Gps::get_rotation() const {
+	auto* gps = ready(_port);
+	return gps == nullptr ? PROS_ERR_F : gps->heading + gps->zero;
+}
+
+std::int32_t Gps::set_rotation(double target) const {
+	auto* gps = ready(_port);
+	if (gps == nullptr) {
+		return PROS_ERR;
+	}
+	gps->zero = target - gps->heading;
+	return 1;
+}
+
+std::int32_t Gps::tare_rotation() const {
+	return set_rotation(0);
+}
+
+pros::c::gps_gyro_s_t Gps::get_gyro_rate() const {
+	if (ready(_port) == nullptr) {
+		return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+	}
+	return {0, 0, 0};
+}
+
+pros::c::gps_accel_s_t Gps::get_accel() const {
+	if (ready(_port) == nullptr) {
+		return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+	}
+	return {0, 0, 1};
+}
+
+}
@@ -0,0 +1,188 @@
+#include "sim.hpp"
+#include "pros/imu.hpp"
+#include <cerrno>
+#include <cmath>
+
+namespace {
+
+// The sensor as a reader sees it, or nullptr with errno set when the port is
+// empty or still calibrating, which is when PROS returns PROS_ERR_F.
+inline sim::Imu* ready(std::uint8_t port) {
+	auto& imu = sim::world().imu(port);
+	if (!imu.present) {
+		errno = ENODEV;
+		return nullptr;
+	}
+	if (sim::world().millis() < imu.calibrated_at) {
+		errno = EAGAIN;
+		return nullptr;
+	}
+	return &imu;
+}
+
+inline double wrap(double degrees, double low) {
+	degrees = std::fmod(degrees - low, 360.0);
+	return (degrees < 0 ? degrees + 360.0 : degrees) + low;
+}
+
+inline std::int32_t set(std::uint8_t port, double target) {
+	auto* imu = ready(port);
+	if (imu == nullptr) {
+		return PROS_ERR;
+	}
+	imu->zero = target - imu->sample_rotation;
+	return 1;
+}
+
+}
+
+namespace pros {
+
+// Calibration takes two seconds, as on the real sensor, and zeroes rotation.
+std::int32_t Imu::reset(bool blocking) const {
+	auto& imu = sim::world().imu(_port);
+	if (!imu.present) {
+		errno = ENODEV;
+		return PROS_ERR;
+	}
+	imu.calibrated_at = sim::world().millis() + 2000;
+	imu.zero = -imu.rotation;
+	while (blocking && sim::world().millis() < imu.calibrated_at) {
+		pros::delay(10);
+	}
+	return 1;
+}
+
+std::int32_t Imu::set_data_rate(std::uint32_t rate) const {
+	sim::world().imu(_port).data_rate = rate;
+	return 1;
+}
+
+double Imu::get_rotation() const {
+	auto* imu = ready(_port);
+	return imu == nullptr ? PROS_ERR_F : imu->sample_rotation + imu->zero;
+}
+
+double Imu::get_heading() const {
+	double rotation = get_rotation();
+	return std::isfinite(rotation) ? wrap(rotation, 0) : PROS_ERR_F;
+}
+
+double Imu::get_yaw() const {
+	double rotation = get_rotation();
+	return std::isfinite(rotation) ? wrap(rotation, -180) : PROS_ERR_F;
+}
+
+double Imu::get_pitch() const {
+	return ready(_port) == nullptr ? PROS_ERR_F : 0;
+}
+
+double Imu::get_roll() const {
+	return ready(_port) == nullptr ? PROS_ERR_F : 0;
+}
+
+pros::c::euler_s_t Imu::get_euler() const {
+	return {get_pitch(), get_roll(), get_yaw()};
+}
+
+pros::c::quaternion_s_t Imu::get_quaternion() const {
+	double yaw = get_yaw();
+	if (!std::isfinite(yaw)) {
+		return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+	}
+	double half = -yaw * M_PI / 360.0;
+	return {0, 0, std::sin(half), std::cos(half)};
+}
+
+pros::c::imu_gyro_s_t Imu::get_gyro_rate() const {
+	auto* imu = ready(_port);
+	if (imu == nullptr) {
+		return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+	}
+	return {0, 0, -(imu->rate + imu->drift)};
+}
+
+pros::c::imu_accel_s_t Imu::get_accel() const {
+	if (ready(_port) == nullptr) {
+		return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+	}
+	return {0, 0, 1};
+}
+
+std::int32_t Imu::tare_rotation() const {
+	return set(_port, 0);
+}
+
+std::int32_t Imu::tare_heading() const {
+	return set(_port, 0);
+}
+
+std::int32_t Imu::tare_yaw() const {
+	return set(_port, 0);
+}
+
+std::int32_t Imu::tare_pitch() const {
+	return ready(_port) == nullptr ? PROS_ERR : 1;
+}
+
+std::int32_t Imu::tare_roll() const {
+	return ready(_port) == nullptr ? PROS_ERR : 1;
+}
+
+std::int32_t Imu::tare_euler() const {
+	return set(_port, 0);
+}
+
+std::int32_t Imu::tare() const {
+	return set(_port, 0);
+}
+
+std::int32_t Imu::set_rotation(const double target) const {
+	return set(_port, target);
+}
+
+std::int32_t Imu::set_heading(const double target) const {
+	auto* imu = ready(_port);
+	if (imu == nullptr) {
+		return PROS_ERR;
+	}
+	double rotation = imu->sample_rotation + imu->zero;
+	return set(_port, rotation - wrap(rotation, 0) + target);
+}
+
+std::int32_t Imu::set_yaw(const double target) const {
+	auto* imu = ready(_port);
+	if (imu == nullptr) {
+		return PROS_ERR;
+	}
+	double rotation = imu->sample_rotation + imu->zero;
+	return set(_port, rotation - wrap(rotation, -180) + target);
+}
+
+std::int32_t Imu::set_pitch(const double) const {
+	return ready(_port) == nullptr ? PROS_ERR : 1;
+}
+
+std::int32_t Imu::set_roll(const double) const {
+	return ready(_port) == nullptr ? PROS_ERR : 1;
+}
+
+std::int32_t Imu::set_euler(const pros::c::euler_s_t target) const {
+	return set_yaw(target.yaw);
+}
+
+pros::c::imu_status_e_t Imu::get_status() const {
+	auto& imu = sim::world().imu(_port);
+	if (!imu.present) {
+		errno = ENODEV;
+		return pros::c::E_IMU_STATUS_ERROR;
+	}
+	return sim::world().millis() < imu.calibrated_at ? pros::c::E_IMU_STATUS_CALIBRATING
+	                                                : static_cast<pros::c::imu_status_e_t>(0);
+}
+
+bool Imu::is_calibrating() const {
+	return get_status() == pros::c::E_IMU_STATUS_CALIBRATING;
+}
+
+}
@@ -0,0 +1,59 @@
+#include "sim.hpp"
+#include "pros/llemu.hpp"
+#include <cstdarg>
+#include <cstdio>
+
+namespace pros {
+namespace lcd {
+
+bool is_initialized(void) {
+	return true;
+}
+
+bool initialize(void) {
+	return true;
+}
+
+bool shutdown(void) {
+	return true;
+}
+
+bool set_text(std::int16_t line, std::string text) {
+	auto& world = sim::world();
+	if (line < 0 || line >= static_cast<std::int16_t>(world.lcd.size())) {
+		return false;
+	}
+	world.lcd[line] = std::move(text);
+	if (world.lcd_echo) {
+		std::printf("[%6u ms] lcd %d: %s\n", world.millis(), line, world.lcd[line].c_str());
+	}
+	return true;
+}
+
+bool clear(void) {
+	for (auto& line : sim::world().lcd) {
+		line.clear();
+	}
+	return true;
+}
+
+bool clear_line(std::int16_t line) {
+	return set_text(line, "");
+}
+
+}
+
+namespace c {
+
+bool lcd_print(int16_t line, const char* fmt, ...) {
+	char buffer[128];
+	va_list args;
+	va_start(args, fmt);
+	std::vsnprintf(buffer, sizeof(buffer), fmt, args);
+	va_end(args);
+	return pros::lcd::set_text(line, buffer);
+}
+
+}
+
+}
@@ -0,0 +1,93 @@
+#include "sim.hpp"
+#include "pros/misc.hpp"
+
+namespace {
+
+inline sim::Controller& device(pros::controller_id_e_t id) {
+	return sim::world().controllers.at(id);
+}
+
+}
+
+namespace pros {
+
+Controller::Controller(controller_id_e_t id) : _id(id) {
+}
+
+std::int32_t Controller::is_connected(void) {
+	return 1;
+}
+
+std::int32_t Controller::get_analog(controller_analog_e_t channel) {
+	return device(_id).analog.at(channel);
+}
+
+std::int32_t Controller::get_battery_capacity(void) {
+	return 100;
+}
+
+std::int32_t Controller::get_battery_level(void) {
+	return 100;
+}
+
+std::int32_t Controller::get_digital(controller_digital_e_t button) {
+	return device(_id).digital.at(button);
+}
+
+std::int32_t Controller::get_digital_new_press(controller_digital_e_t button) {
+	auto& controller = device(_id);
+	bool pressed = controller.digital.at(button);
+	bool fresh = pressed && !controller.latched.at(button);
+	controller.latched.at(button) = pressed;
+	return fresh;
+}
+
+std::int32_t Controller::set_text(std::uint8_t, std::uint8_t, const char*) {
+	return 1;
+}
+
+std::int32_t Controller::set_text(std::uint8_t, std::uint8_t, const std::string&) {
+	return 1;
+}
+
+std::int32_t Controller::clear_line(std::uint8_t) {
+	return 1;
+}
+
+std::int32_t Controller::rumble(const char*) {
+	return 1;
+}
+
+std::int32_t Controller::clear(void) {
+	return 1;
+}
+
+namespace competition {
+
+std::uint8_t get_status(void) {
+	return sim::world().autonomous ? COMPETITION_AUTONOMOUS : 0;
+}
+
+std::uint8_t is_autonomous(void) {
+	return sim::world().autonomous;
+}
+
+std::uint8_t is_connected(void) {
+	return 0;
+}
+
+std::uint8_t is_disabled(void) {
+	return 0;
+}
+
+}
+
+namespace c {
+
+int32_t controller_print(controller_id_e_t, uint8_t, uint8_t, const char*, ...) {
+	return 1;
+}
+
+}
+
+}
@@ -0,0 +1,464 @@
+#include "sim.hpp"
+#include "pros/motors.hpp"
+#include <cmath>
+
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+namespace {
+
+inline sim::Motor& device(std::uint8_t port) {
+	return sim::world().motor(port);
+}
+
+}
+
+namespace pros {
+
+Motor::Motor(const std::int8_t port, const motor_gearset_e_t gearset, const bool reverse,
+             const motor_encoder_units_e_t encoder_units) :
+_port(std::abs(port)) {
+	set_gearing(gearset);
+	set_reversed(port < 0 ? !reverse : reverse);
+	set_encoder_units(encoder_units);
+}
+
+Motor::Motor(const std::int8_t port, const motor_gearset_e_t gearset, const bool reverse) :
+_port(std::abs(port)) {
+	set_gearing(gearset);
+	set_reversed(port < 0 ? !reverse : reverse);
+}
+
+Motor::Motor(const std::int8_t port, const motor_gearset_e_t gearset) : _port(std::abs(port)) {
+	set_gearing(gearset);
+	if (port < 0) {
+		set_reversed(true);
+	}
+}
+
+Motor::Motor(const std::int8_t port, const bool reverse) : _port(std::abs(port)) {
+	set_reversed(port < 0 ? !reverse : reverse);
+}
+
+Motor::Motor(const std::int8_t port) : _port(std::abs(port)) {
+	if (port < 0) {
+		set_reversed(true);
+	}
+}
+
+std::int32_t Motor::operator=(std::int32_t voltage) const {
+	return move(voltage);
+}
+
+std::int32_t Motor::move(std::int32_t voltage) const {
+	return move_voltage(std::clamp(voltage, -127, 127) * 12000 / 127);
+}
+
+std::int32_t Motor::move_absolute(const double position, const std::int32_t velocity) const {
+	auto& m = device(_port);
+	m.mode = sim::Motor::Mode::position;
+	m.target = velocity;
+	m.target_position = position;
+	return 1;
+}
+
+std::int32_t Motor::move_relative(const double position, const std::int32_t velocity) const {
+	return move_absolute(get_target_position() + position, velocity);
+}
+
+std::int32_t Motor::move_velocity(const std::int32_t velocity) const {
+	auto& m = device(_port);
+	m.mode = sim::Motor::Mode::velocity;
+	m.target = velocity;
+	return 1;
+}
+
+std::int32_t Motor::move_voltage(const std::int32_t voltage) const {
+	auto& m = device(_port);
+	m.mode = sim::Motor::Mode::voltage;
+	m.target = std::clamp(voltage, -12000, 12000);
+	return 1;
+}
+
+std::int32_t Motor::brake(void) const {
+	return move_velocity(0);
+}
+
+std::int32_t Motor::modify_profiled_velocity(const std::int32_t velocity) const {
+	device(_port).target = velocity;
+	return 1;
+}
+
+double Motor::get_target_position(void) const {
+	auto& m = device(_port);
+	return m.mode == sim::Motor::Mode::position ? m.target_position : get_position();
+}
+
+std::int32_t Motor::get_target_velocity(void) const {
+	auto& m = device(_port);
+	return m.mode == sim::Motor::Mode::voltage ? 0 : m.target;
+}
+
+double Motor::get_actual_velocity(void) const {
+	auto& m = device(_port);
+	return m.velocity * m.direction() * m.report_scale();
+}
+
+std::int32_t Motor::get_current_draw(void) const {
+	auto& m = device(_port);
+	return std::abs(m.torque) / m.stall_torque() * 2500;
+}
+
+std::int32_t Motor::get_direction(void) const {
+	return get_actual_velocity() < 0 ? -1 : 1;
+}
+
+double Motor::get_efficiency(void) const {
+	auto& m = device(_port);
+	double speed = std::abs(m.velocity) / m.free_rpm();
+	return 100.0 * 4 * speed * (1 - speed);
+}
+
+std::int32_t Motor::is_over_current(void) const {
+	return get_current_draw() >= device(_port).current_limit;
+}
+
+std::int32_t Motor::is_stopped(void) const {
+	return std::abs(device(_port).velocity) < 1;
+}
+
+std::int32_t Motor::get_zero_position_flag(void) const {
+	return std::abs(get_position()) < 1;
+}
+
+std::uint32_t Motor::get_faults(void) const {
+	return 0;
+}
+
+std::uint32_t Motor::get_flags(void) const {
+	return is_stopped() ? E_MOTOR_FLAGS_ZERO_VELOCITY : 0;
+}
+
+std::int32_t Motor::get_raw_position(std::uint32_t* const timestamp) const {
+	if (timestamp != nullptr) {
+		*timestamp = pros::c::millis();
+	}
+	return device(_port).position * device(_port).direction();
+}
+
+std::int32_t Motor::is_over_temp(void) const {
+	return 0;
+}
+
+double Motor::get_position(void) const {
+	auto& m = device(_port);
+	return m.position * m.direction() * m.report_scale() - m.zero;
+}
+
+double Motor::get_power(void) const {
+	auto& m = device(_port);
+	return std::abs(m.voltage / 1000.0 * get_current_draw() / 1000.0);
+}
+
+double Motor::get_temperature(void) const {
+	return device(_port).temperature;
+}
+
+double Motor::get_torque(void) const {
+	auto& m = device(_port);
+	return m.torque * m.direction();
+}
+
+std::int32_t Motor::get_voltage(void) const {
+	auto& m = device(_port);
+	return m.voltage * m.direction();
+}
+
+std::int32_t Motor::set_zero_position(const double position) const {
+	auto& m = device(_port);
+	m.zero = m.position * m.direction() * m.report_scale() - position;
+	return 1;
+}
+
+std::int32_t Motor::tare_position(void) const {
+	return set_zero_position(0);
+}
+
+std::int32_t Motor::set_brake_mode(const motor_brake_mode_e_t mode) const {
+	device(_port).brake_mode = mode;
+	return 1;
+}
+
+std::int32_t Motor::set_current_limit(const std::int32_t limit) const {
+	device(_port).current_limit = std::clamp(limit, 0, 2500);
+	return 1;
+}
+
+std::int32_t Motor::set_encoder_units(const motor_encoder_units_e_t units) const {
+	device(_port).encoder_units = units;
+	return 1;
+}
+
+std::int32_t Motor::set_gearing(const motor_gearset_e_t gearset) const {
+	device(_port).gearset = gearset;
+	return 1;
+}
+
+motor_pid_s_t Motor::convert_pid(double kf, double kp, double ki, double kd) {
+	return motor_pid_s_t{static_cast<uint8_t>(kf * 16), static_cast<uint8_t>(kp * 16), static_cast<uint8_t>(ki * 16),
+	                     static_cast<uint8_t>(kd * 16)};
+}
+
+motor_pid_full_s_t Motor::convert_pid_full(double kf, double kp, double ki, double kd, double filter, double limit,
+                                           double threshold, double loopspeed) {
+	return motor_pid_full_s_t{static_cast<uint8_t>(kf * 16),
+	                          static_cast<uint8_t>(kp * 16),
+	                          static_cast<uint8_t>(ki * 16),
+	                          static_cast<uint8_t>(kd * 16),
+	                          static_cast<uint8_t>(filter * 16),
+	                          static_cast<uint16_t>(limit * 16),
+	                          static_cast<uint8_t>(threshold * 16),
+	                          static_cast<uint8_t>(loopspeed * 16)};
+}
+
+std::int32_t Motor::set_pos_pid(const motor_pid_s_t) const {
+	return 1;
+}
+
+std::int32_t Motor::set_pos_pid_full(const motor_pid_full_s_t) const {
+	return 1;
+}
+
+std::int32_t Motor::set_vel_pid(const motor_pid_s_t) const {
+	return 1;
+}
+
+std::int32_t Motor::set_vel_pid_full(const motor_pid_full_s_t) const {
+	return 1;
+}
+
+std::int32_t Motor::set_reversed(const bool reverse) const {
+	device(_port).reversed = reverse;
+	return 1;
+}
+
+std::int32_t Motor::set_voltage_limit(const std::int32_t limit) const {
+	device(_port).voltage_limit = limit;
+	return 1;
+}
+
+motor_brake_mode_e_t Motor::get_brake_mode(void) const {
+	return device(_port).brake_mode;
+}
+
+std::int32_t Motor::get_current_limit(void) const {
+	return device(_port).current_limit;
+}
+
+motor_encoder_units_e_t Motor::get_encoder_units(void) const {
+	return device(_port).encoder_units;
+}
+
+motor_gearset_e_t Motor::get_gearing(void) const {
+	return device(_port).gearset;
+}
+
+motor_pid_full_s_t Motor::get_pos_pid(void) const {
+	return motor_pid_full_s_t{};
+}
+
+motor_pid_full_s_t Motor::get_vel_pid(void) const {
+	return motor_pid_full_s_t{};
+}
+
+std::int32_t Motor::is_reversed(void) const {
+	return device(_port).reversed;
+}
+
+std::int32_t Motor::get_voltage_limit(void) const {
+	return device(_port).voltage_limit;
+}
+
+std::uint8_t Motor::get_port(void) const {
+	return _port;
+}
+
+Motor_Group::Motor_Group(const std::initializer_list<Motor> motors) :
+_motors(motors), _motor_count(motors.size()) {
+}
+
+Motor_Group::Motor_Group(const std::vector<std::int8_t> motor_ports) : _motor_count(motor_ports.size()) {
+	for (auto port : motor_ports) {
+		_motors.emplace_back(port);
+	}
+}
+
+std::int32_t Motor_Group::operator=(std::int32_t voltage) {
+	return move(voltage);
+}
+
+std::int32_t Motor_Group::move(std::int32_t voltage) {
+	for (auto& motor : _motors) {
+		motor.move(voltage);
+	}
+	return 1;
+}
+
+std::int32_t Motor_Group::move_absolute(const double position, const std::int32_t velocity) {
+	for (auto& motor : _motors) {
+		motor.move_absolute(position, velocity);
+	}
+	return 1;
+}
+
+std::int32_t Motor_Group::move_relative(const double position, const std::int32_t velocity) {
+	for (auto& motor : _motors) {
+		motor.move_relative(position, velocity);
+	}
+	return 1;
+}
+
+std::int32_t Motor_Group::move_velocity(const std::int32_t velocity) {
+	for (auto& motor : _motors) {
+		motor.move_velocity(velocity);
+	}
+	return 1;
+}
+
+std::int32_t Motor_Group::move_voltage(const std::int32_t voltage) {
+	for (auto& motor : _motors) {
+		motor.move_voltage(voltage);
+	}
+	return 1;
+}
+
+std::int32_t Motor_Group::brake(void) {
+	for (auto& motor : _motors) {
+		motor.brake();
+	}
+	return 1;
+}
+
+pros::Motor& Motor_Group::operator[](int i) {
+	return _motors.at(i);
+}
+
+std::int32_t Motor_Group::size() {
+	return _motor_count;
+}
+
+std::int32_t Motor_Group::set_zero_position(const double position) {
+	for (auto& motor : _motors) {
+		motor.set_zero_position(position);
+	}
+	return 1;
+}
+
+std::int32_t Motor_Group::set_brake_modes(motor_brake_mode_e_t mode) {
+	for (auto& motor : _motors) {
+		motor.set_brake_mode(mode);
+	}
+	return 1;
+}
+
+std::int32_t Motor_Group::set_reversed(const bool reversed) {
+	for (auto& motor : _motors) {
+		motor.set_reversed(reversed);
+	}
+	return 1;
+}
+
+std::int32_t Motor_Group::set_voltage_limit(const std::int32_t limit) {
+	for (auto& motor : _motors) {
+		motor.set_voltage_limit(limit);
+	}
+	return 1;
+}
+
+std::int32_t Motor_Group::set_gearing(const motor_gearset_e_t gearset) {
+	for (auto& motor : _motors) {
+		motor.set_gearing(gearset);
+	}
+	return 1;
+}
+
+std::int32_t Motor_Group::set_encoder_units(const motor_encoder_units_e_t units) {
+	for (auto& motor : _motors) {
+		motor.set_encoder_units(units);
+	}
+	return 1;
+}
+
+std::int32_t Motor_Group::tare_position(void) {
+	for (auto& motor : _motors) {
+		motor.tare_position();
+	}
+	return 1;
+}
+
+template <typename T, typename F>
+static std::vector<T> collect(std::vector<Motor>& motors, F getter) {
+	std::vector<T> values;
+	values.reserve(motors.size());
+	for (auto& motor : motors) {
+		values.push_back((motor.*getter)());
+	}
+	return values;
+}
+
+std::vector<double> Motor_Group::get_actual_velocities(void) {
+	return collect<double>(_motors, &Motor::get_actual_velocity);
+}
+
+std::vector<std::int32_t> Motor_Group::get_target_velocities(void) {
+	return collect<std::int32_t>(_motors, &Motor::get_target_velocity);
+}
+
+std::vector<double> Motor_Group::get_target_positions(void) {
+	return collect<double>(_motors, &Motor::get_target_position);
+}
+
+std::vector<double> Motor_Group::get_positions(void) {
+	return collect<double>(_motors, &Motor::get_position);
+}
+
+std::vector<double> Motor_Group::get_efficiencies(void) {
+	return collect<double>(_motors, &Motor::get_efficiency);
+}
+
+std::vector<std::int32_t> Motor_Group::are_over_current(void) {
+	return collect<std::int32_t>(_motors, &Motor::is_over_current);
+}
+
+std::vector<std::int32_t> Motor_Group::are_over_temp(void) {
+	return collect<std::int32_t>(_motors, &Motor::is_over_temp);
+}
+
+std::vector<pros::motor_brake_mode_e_t> Motor_Group::get_brake_modes(void) {
+	return collect<pros::motor_brake_mode_e_t>(_motors, &Motor::get_brake_mode);
+}
+
+std::vector<motor_gearset_e_t> Motor_Group::get_gearing(void) {
+	return collect<motor_gearset_e_t>(_motors, &Motor::get_gearing);
+}
+
+std::vector<std::int32_t> Motor_Group::get_current_draws(void) {
+	return collect<std::int32_t>(_motors, &Motor::get_current_draw);
+}
+
+std::vector<std::int32_t> Motor_Group::get_current_limits(void) {
+	return collect<std::int32_t>(_motors, &Motor::get_current_limit);
+}
+
+std::vector<std::uint8_t> Motor_Group::get_ports(void) {
+	return collect<std::uint8_t>(_motors, &Motor::get_port);
+}
+
+std::vector<std::int32_t> Motor_Group::get_directions(void) {
+	return collect<std::int32_t>(_motors, &Motor::get_direction);
+}
+
+std::vector<pros::motor_encoder_units_e_t> Motor_Group::get_encoder_units(void) {
+	return collect<pros::motor_encoder_units_e_t>(_motors, &Motor::get_encoder_units);
+}
+
+}
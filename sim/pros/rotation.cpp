@@ -0,0 +1,71 @@
+#include "sim.hpp"
+#include "pros/rotation.hpp"
+
+namespace {
+
+inline sim::Rotation& device(std::uint8_t port) {
+	return sim::world().rotation(port);
+}
+
+}
+
+namespace pros {
+
+// Position is reported in centidegrees and velocity in degrees per second, the
+// units Odom and Flywheel read them in.
+Rotation::Rotation(const std::uint8_t port, const bool reverse_flag) : _port(port) {
+	set_reversed(reverse_flag);
+}
+
+std::int32_t Rotation::reset() {
+	return reset_position();
+}
+
+std::int32_t Rotation::set_data_rate(std::uint32_t rate) const {
+	device(_port).data_rate = rate;
+	return 1;
+}
+
+std::int32_t Rotation::set_position(std::uint32_t position) {
+	auto& r = device(_port);
+	r.zero = static_cast<std::int32_t>(position) - r.sample_angle * r.direction() * 100;
+	return 1;
+}
+
+std::int32_t Rotation::reset_position(void) {
+	return set_position(0);
+}
+
+std::int32_t Rotation::get_position() {
+	auto& r = device(_port);
+	return r.sample_angle * r.direction() * 100 + r.zero;
+}
+
+std::int32_t Rotation::get_velocity() {
+	auto& r = device(_port);
+	return r.sample_velocity * r.direction();
+}
+
+std::int32_t Rotation::get_angle() {
+	std::int32_t angle = get_position() % 36000;
+	return angle < 0 ? angle + 36000 : angle;
+}
+
+std::int32_t Rotation::set_reversed(bool value) {
+	auto& r = device(_port);
+	if (r.reversed != value) {
+		r.zero = -r.zero;
+		r.reversed = value;
+	}
+	return 1;
+}
+
+std::int32_t Rotation::reverse() {
+	return set_reversed(!device(_port).reversed);
+}
+
+std::int32_t Rotation::get_reversed() {
+	return device(_port).reversed;
+}
+
+}
@@ -0,0 +1,307 @@
+#include "sim.hpp"
+#include "pros/rtos.hpp"
+
+namespace {
+
+struct MutexState {
+	sim::Kernel::Task* owner = nullptr;
+};
+
+inline sim::Kernel& kernel() {
+	return sim::world().kernel;
+}
+
+inline sim::Kernel::Task* resolve(pros::task_t task) {
+	return task == nullptr ? kernel().current() : static_cast<sim::Kernel::Task*>(task);
+}
+
+}
+
+namespace pros {
+namespace c {
+
+uint32_t millis(void) {
+	return kernel().millis();
+}
+
+uint64_t micros(void) {
+	return static_cast<uint64_t>(kernel().millis()) * 1000;
+}
+
+task_t task_create(task_fn_t function, void* const parameters, uint32_t prio, const uint16_t, const char* const name) {
+	return kernel().spawn(function, parameters, prio, name);
+}
+
+void task_delete(task_t task) {
+	kernel().remove(resolve(task));
+}
+
+void task_delay(const uint32_t milliseconds) {
+	kernel().delay(milliseconds);
+}
+
+void delay(const uint32_t milliseconds) {
+	kernel().delay(milliseconds);
+}
+
+void task_delay_until(uint32_t* const prev_time, const uint32_t delta) {
+	kernel().delay_until(prev_time, delta);
+}
+
+uint32_t task_get_priority(task_t task) {
+	return resolve(task)->priority;
+}
+
+void task_set_priority(task_t task, uint32_t prio) {
+	resolve(task)->priority = prio;
+}
+
+task_state_e_t task_get_state(task_t task) {
+	auto* t = resolve(task);
+	if (t->done) {
+		return E_TASK_STATE_DELETED;
+	} else if (t == kernel().current()) {
+		return E_TASK_STATE_RUNNING;
+	} else if (t->suspended) {
+		return E_TASK_STATE_SUSPENDED;
+	} else if (t->wake > kernel().millis()) {
+		return E_TASK_STATE_BLOCKED;
+	}
+	return E_TASK_STATE_READY;
+}
+
+void task_suspend(task_t task) {
+	auto* t = resolve(task);
+	t->suspended = true;
+	if (t == kernel().current()) {
+		kernel().yield();
+	}
+}
+
+void task_resume(task_t task) {
+	resolve(task)->suspended = false;
+}
+
+uint32_t task_get_count(void) {
+	uint32_t count = 0;
+	for (auto& task : kernel().all()) {
+		count += !task->done;
+	}
+	return count;
+}
+
+char* task_get_name(task_t task) {
+	return resolve(task)->name.data();
+}
+
+task_t task_get_by_name(const char* name) {
+	for (auto& task : kernel().all()) {
+		if (!task->done && task->name == name) {
+			return task.get();
+		}
+	}
+	return nullptr;
+}
+
+task_t task_get_current() {
+	return kernel().current();
+}
+
+uint32_t task_notify(task_t task) {
+	resolve(task)->notification++;
+	return 1;
+}
+
+void task_join(task_t task) {
+	auto* t = resolve(task);
+	while (!t->done) {
+		kernel().delay(1);
+	}
+}
+
+uint32_t task_notify_ext(task_t task, uint32_t value, notify_action_e_t action, uint32_t* prev_value) {
+	auto* t = resolve(task);
+	if (prev_value != nullptr) {
+		*prev_value = t->notification;
+	}
+
+	switch (action) {
+		case E_NOTIFY_ACTION_BITS: t->notification |= value; break;
+		case E_NOTIFY_ACTION_INCR: t->notification++; break;
+		case E_NOTIFY_ACTION_OWRITE: t->notification = value; break;
+		case E_NOTIFY_ACTION_NO_OWRITE:
+			if (t->notification != 0) {
+				return 0;
+			}
+			t->notification = value;
+			break;
+		default: break;
+	}
+	return 1;
+}
+
+uint32_t task_notify_take(bool clear_on_exit, uint32_t timeout) {
+	auto* t = kernel().current();
+	uint32_t start = kernel().millis();
+
+	while (t->notification == 0) {
+		if (timeout != TIMEOUT_MAX && kernel().millis() - start >= timeout) {
+			return 0;
+		}
+		kernel().delay(1);
+	}
+
+	uint32_t value = t->notification;
+	t->notification = clear_on_exit ? 0 : value - 1;
+	return value;
+}
+
+bool task_notify_clear(task_t task) {
+	auto* t = resolve(task);
+	bool pending = t->notification != 0;
+	t->notification = 0;
+	return pending;
+}
+
+mutex_t mutex_create(void) {
+	return new MutexState();
+}
+
+bool mutex_take(mutex_t mutex, uint32_t timeout) {
+	auto* m = static_cast<MutexState*>(mutex);
+	uint32_t start = kernel().millis();
+
+	while (m->owner != nullptr && !m->owner->done) {
+		if (timeout != TIMEOUT_MAX && kernel().millis() - start >= timeout) {
+			return false;
+		}
+		kernel().delay(1);
+	}
+
+	m->owner = kernel().current();
+	return true;
+}
+
+bool mutex_give(mutex_t mutex) {
+	static_cast<MutexState*>(mutex)->owner = nullptr;
+	return true;
+}
+
+void mutex_delete(mutex_t mutex) {
+	delete static_cast<MutexState*>(mutex);
+}
+
+}
+
+Task::Task(task_fn_t function, void* parameters, std::uint32_t prio, std::uint16_t stack_depth, const char* name) :
+task(c::task_create(function, parameters, prio, stack_depth, name)) {
+}
+
+Task::Task(task_fn_t function, void* parameters, const char* name) :
+Task(function, parameters, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, name) {
+}
+
+Task::Task(task_t task) : task(task) {
+}
+
+Task Task::current() {
+	return Task(c::task_get_current());
+}
+
+Task& Task::operator=(task_t in) {
+	task = in;
+	return *this;
+}
+
+void Task::remove() {
+	c::task_delete(task);
+}
+
+std::uint32_t Task::get_priority() {
+	return c::task_get_priority(task);
+}
+
+void Task::set_priority(std::uint32_t prio) {
+	c::task_set_priority(task, prio);
+}
+
+std::uint32_t Task::get_state() {
+	return c::task_get_state(task);
+}
+
+void Task::suspend() {
+	c::task_suspend(task);
+}
+
+void Task::resume() {
+	c::task_resume(task);
+}
+
+const char* Task::get_name() {
+	return c::task_get_name(task);
+}
+
+std::uint32_t Task::notify() {
+	return c::task_notify(task);
+}
+
+void Task::join() {
+	c::task_join(task);
+}
+
+std::uint32_t Task::notify_ext(std::uint32_t value, notify_action_e_t action, std::uint32_t* prev_value) {
+	return c::task_notify_ext(task, value, action, prev_value);
+}
+
+std::uint32_t Task::notify_take(bool clear_on_exit, std::uint32_t timeout) {
+	return c::task_notify_take(clear_on_exit, timeout);
+}
+
+bool Task::notify_clear() {
+	return c::task_notify_clear(task);
+}
+
+void Task::delay(const std::uint32_t milliseconds) {
+	c::task_delay(milliseconds);
+}
+
+void Task::delay_until(std::uint32_t* const prev_time, const std::uint32_t delta) {
+	c::task_delay_until(prev_time, delta);
+}
+
+std::uint32_t Task::get_count() {
+	return c::task_get_count();
+}
+
+Clock::time_point Clock::now() {
+	return time_point{duration{c::millis()}};
+}
+
+Mutex::Mutex() : mutex(c::mutex_create(), c::mutex_delete) {
+}
+
+bool Mutex::take() {
+	return c::mutex_take(mutex.get(), TIMEOUT_MAX);
+}
+
+bool Mutex::take(std::uint32_t timeout) {
+	return c::mutex_take(mutex.get(), timeout);
+}
+
+bool Mutex::give() {
+	return c::mutex_give(mutex.get());
+}
+
+void Mutex::lock() {
+	take();
+}
+
+void Mutex::unlock() {
+	give();
+}
+
+bool Mutex::try_lock() {
+	return c::mutex_take(mutex.get(), 0);
+}
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+namespace sim {
+
+// Small deterministic generator so seeded runs match on every host.
+class Random {
+	std::uint64_t state;
+public:
+	Random(std::uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ull + 1) {
+	}
+
+	inline double uniform(double low, double high) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return low + (high - low) * (state >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	// Box-Muller; throws the second value away to stay stateless.
+	inline double normal(double mean, double sd) {
+		double u = uniform(1e-12, 1);
+		double v = uniform(0, 2 * M_PI);
+		return mean + sd * std::sqrt(-2 * std::log(u)) * std::cos(v);
+	}
+};
+
+}
@@ -0,0 +1,202 @@
+#include "parallel.hpp"
+#include "random.hpp"
+#include "robot.hpp"
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Runs every auton on the simulated robot: once with the nominal model, then
+// many times with seeded perturbations of the drivetrain. Reports routine time,
+// final pose spread and odometry error, and compares the nominal run against
+// a baseline so changes in behaviour show up commit to commit.
+
+struct Result {
+	std::uint32_t routine;
+	std::uint32_t seed;
+	std::uint32_t time;
+	bool finished;
+	sim::Pose pose;
+	Position odom;
+};
+
+static Result simulate(std::uint32_t index, std::uint32_t seed) {
+	auto& routine = sim::hbot_routines().at(index);
+	auto config = sim::hbot_drive();
+
+	sim::World world;
+	if (seed != 0) {
+		sim::Random rng(seed);
+		config.mass *= rng.uniform(0.9, 1.1);
+		config.inertia *= rng.uniform(0.85, 1.15);
+		config.traction *= rng.uniform(0.85, 1.15);
+		config.rolling_resistance *= rng.uniform(0.7, 1.3);
+		config.scrub *= rng.uniform(0.7, 1.3);
+		config.tracking_diameter *= rng.uniform(0.995, 1.005);
+		for (auto port : config.left) {
+			world.motor(port).strength = rng.uniform(0.92, 1.0);
+		}
+		for (auto port : config.right) {
+			world.motor(port).strength = rng.uniform(0.92, 1.0);
+		}
+	}
+
+	auto& drive = sim::hbot_world(world, config);
+	Result result{index, seed, 0, false, {}, {}};
+	result.finished = world.run([&] {
+		initialize();
+		routine.function();
+	}, routine.timeout);
+	result.time = world.millis();
+	result.pose = drive.pose;
+	result.odom = robot->controllers->odom->position();
+	robot.reset();
+	return result;
+}
+
+static std::vector<Result> simulate_all(std::uint32_t runs, unsigned jobs) {
+	std::uint32_t routines = sim::hbot_routines().size();
+	return sim::parallel_map<Result>(routines * (runs + 1), jobs, [&](std::size_t i) {
+		return simulate(i % routines, i / routines);
+	});
+}
+
+static double percentile(std::vector<double> values, double p) {
+	std::sort(values.begin(), values.end());
+	return values.at(std::min(values.size() - 1, static_cast<std::size_t>(p * values.size())));
+}
+
+static double mean(const std::vector<double>& values) {
+	double sum = 0;
+	for (double value : values) {
+		sum += value;
+	}
+	return sum / values.size();
+}
+
+static double wrap_degrees(double degrees) {
+	degrees = std::fmod(degrees + 180, 360);
+	return degrees < 0 ? degrees + 180 : degrees - 180;
+}
+
+struct Baseline {
+	std::uint32_t time;
+	double x;
+	double y;
+	double heading;
+};
+
+static std::map<std::string, Baseline> read_baseline(const std::string& path) {
+	std::map<std::string, Baseline> baseline;
+	std::ifstream file(path);
+	std::string line;
+	std::getline(file, line);
+	while (std::getline(file, line)) {
+		std::replace(line.begin(), line.end(), ',', ' ');
+		std::istringstream fields(line);
+		std::string name;
+		Baseline entry;
+		if (fields >> name >> entry.time >> entry.x >> entry.y >> entry.heading) {
+			baseline[name] = entry;
+		}
+	}
+	return baseline;
+}
+
+int main(int argc, char** argv) {
+	std::uint32_t runs = 200;
+	unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+	std::string baseline_path = "regress.csv";
+	bool update = false;
+
+	for (int i = 1; i < argc; i++) {
+		if (!std::strcmp(argv[i], "-n") && i + 1 < argc) {
+			runs = std::atoi(argv[++i]);
+		} else if (!std::strcmp(argv[i], "-j") && i + 1 < argc) {
+			jobs = std::max(1, std::atoi(argv[++i]));
+		} else if (!std::strcmp(argv[i], "--baseline") && i + 1 < argc) {
+			baseline_path = argv[++i];
+		} else if (!std::strcmp(argv[i], "--update")) {
+			update = true;
+		} else {
+			std::fprintf(stderr, "usage: %s [-n runs] [-j jobs] [--baseline file] [--update]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	auto results = simulate_all(runs, jobs);
+	double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	auto baseline = read_baseline(baseline_path);
+	std::ofstream updated;
+	if (update) {
+		updated.open(baseline_path);
+		updated << "routine,time_ms,x_cm,y_cm,heading_deg\n";
+	}
+
+	bool changed = false;
+	std::printf("%-7s %9s %9s %9s %9s %9s %9s %9s  %s\n", "routine", "time ms", "mean ms", "max ms",
+	            "spread", "p95", "max", "odom err", "baseline");
+
+	for (std::uint32_t index = 0; index < sim::hbot_routines().size(); index++) {
+		auto& routine = sim::hbot_routines()[index];
+		const Result* nominal = nullptr;
+		std::vector<double> times, spread, odom_error;
+
+		for (auto& result : results) {
+			if (result.routine == index && result.seed == 0) {
+				nominal = &result;
+			}
+		}
+		for (auto& result : results) {
+			if (result.routine != index) {
+				continue;
+			}
+			times.push_back(result.time);
+			odom_error.push_back(std::hypot(result.odom.x - result.pose.x, result.odom.y - result.pose.y));
+			if (result.seed != 0) {
+				spread.push_back(std::hypot(result.pose.x - nominal->pose.x, result.pose.y - nominal->pose.y));
+			}
+		}
+		if (spread.empty()) {
+			spread.push_back(0);
+		}
+
+		double heading = nominal->pose.theta * RADIAN_TO_DEGREE;
+		std::string status = "new";
+		auto entry = baseline.find(routine.name);
+		if (entry != baseline.end()) {
+			double moved = std::hypot(nominal->pose.x - entry->second.x, nominal->pose.y - entry->second.y);
+			double turned = std::abs(wrap_degrees(heading - entry->second.heading));
+			long slower = static_cast<long>(nominal->time) - entry->second.time;
+			bool same = moved < 0.5 && turned < 0.5 && slower == 0;
+			changed |= !same;
+
+			char buffer[96];
+			std::snprintf(buffer, sizeof(buffer), "%s (%+.1f cm, %+.1f deg, %+ld ms)", same ? "ok" : "CHANGED",
+			              moved, turned, slower);
+			status = buffer;
+		}
+
+		std::printf("%-7s %9u %9.0f %9.0f %9.2f %9.2f %9.2f %9.2f  %s%s\n", routine.name, nominal->time,
+		            mean(times), percentile(times, 1.0), mean(spread), percentile(spread, 0.95),
+		            percentile(spread, 1.0), mean(odom_error), status.c_str(), nominal->finished ? "" : " [timed out]");
+
+		if (update) {
+			updated << routine.name << "," << nominal->time << "," << nominal->pose.x << "," << nominal->pose.y
+			        << "," << heading << "\n";
+		}
+	}
+
+	std::printf("\n%zu runs in %.2f s on %u workers (%.0f runs/s)\n", results.size(), wall, jobs,
+	            results.size() / wall);
+	return changed && !update ? 1 : 0;
+}
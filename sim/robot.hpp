@@ -0,0 +1,58 @@
+#pragma once
+#include "main.h"
+#include "hbot.hpp"
+#include "drive.hpp"
+#include "flywheel.hpp"
+#include "sim.hpp"
+
+// The robot as wired in initialize() in src/main.cpp.
+extern std::unique_ptr<Robot> robot;
+void auto_left();
+void auto_right();
+void auto_solo();
+void auto_skills();
+void auto_characterize();
+
+namespace sim {
+
+inline DriveConfig hbot_drive() {
+	DriveConfig config;
+	config.left = {19, -17, -18};
+	config.right = {-12, 11, 13};
+	config.left_sensor = 8;
+	config.right_sensor = 6;
+	config.imu = 7;
+	return config;
+}
+
+inline FlywheelConfig hbot_flywheel() {
+	FlywheelConfig config;
+	config.motors = {-10};
+	config.sensor = 9;
+	config.indexer = 'B';
+	return config;
+}
+
+// Attaches the robot's plants to a fresh world and returns the drivetrain.
+inline Drivetrain& hbot_world(World& world, DriveConfig drive = hbot_drive()) {
+	world.attach<FlywheelPlant>(world, hbot_flywheel());
+	return world.attach<Drivetrain>(world, std::move(drive));
+}
+
+struct Routine {
+	const char* name;
+	void (*function)();
+	std::uint32_t timeout;
+};
+
+inline const std::vector<Routine>& hbot_routines() {
+	static const std::vector<Routine> routines = {
+		{"left", auto_left, 15000},
+		{"right", auto_right, 15000},
+		{"solo", auto_solo, 15000},
+		{"skills", auto_skills, 60000},
+	};
+	return routines;
+}
+
+}
@@ -0,0 +1,251 @@
+#pragma once
+#include "api.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <csetjmp>
+#include <ucontext.h>
+
+// Host stand-in for the parts of PROS that hbot.hpp uses. Every pros:: call made
+// from robot code lands in the World owned by the calling OS thread, so several
+// worlds can run side by side on different threads. Tasks are cooperative
+// coroutines on a virtual millisecond clock: time only moves when every task is
+// blocked in delay(), which makes a run deterministic and as fast as the host.
+// Switches use _setjmp/_longjmp rather than swapcontext to skip the signal
+// mask syscalls, which otherwise dominate a run.
+namespace sim {
+
+// Thrown out of delay() in a task that has been removed, so its stack unwinds.
+struct TaskKilled {};
+
+// Thrown out of delay() in the host task once the run deadline has passed.
+struct Timeout {};
+
+class Kernel {
+public:
+	struct Task {
+		ucontext_t context;       // only used to enter the task the first time
+		std::jmp_buf jump;        // where the task resumes after a switch
+		std::unique_ptr<char[]> stack;
+		pros::task_fn_t function = nullptr;
+		void* parameters = nullptr;
+		std::string name;
+		std::uint32_t priority = TASK_PRIORITY_DEFAULT;
+		std::uint32_t wake = 0;
+		std::uint64_t order = 0;
+		std::uint32_t notification = 0;
+		bool started = false;
+		bool suspended = false;
+		bool killed = false;
+		bool done = false;
+	};
+
+	Kernel();
+	~Kernel();
+
+	Task* spawn(pros::task_fn_t function, void* parameters, std::uint32_t priority, const char* name);
+	void remove(Task* task);
+	void remove_all();
+
+	void delay(std::uint32_t ms);
+	void delay_until(std::uint32_t* prev_time, std::uint32_t delta);
+	void yield();
+
+	inline std::uint32_t millis() const {
+		return now;
+	}
+
+	inline Task* current() const {
+		return running;
+	}
+
+	inline Task* host() const {
+		return tasks.front().get();
+	}
+
+	const std::vector<std::unique_ptr<Task>>& all() const {
+		return tasks;
+	}
+
+	// Called once for every virtual millisecond the clock advances.
+	std::function<void(std::uint32_t)> on_tick;
+
+	// The host task gets sim::Timeout from delay() once the clock passes this.
+	std::uint32_t deadline = UINT32_MAX;
+
+	static constexpr std::size_t STACK_SIZE = 256 * 1024;
+
+private:
+	std::vector<std::unique_ptr<Task>> tasks;
+	Task* running;
+	std::uint32_t now = 0;
+	std::uint64_t counter = 0;
+
+	Task* next();
+	void dispatch();
+	void switch_to(Task* task);
+	static void entry();
+};
+
+struct Motor {
+	enum class Mode { voltage, velocity, position };
+
+	pros::motor_gearset_e_t cartridge = pros::E_MOTOR_GEARSET_18;
+	pros::motor_gearset_e_t gearset = pros::E_MOTOR_GEARSET_18;
+	pros::motor_brake_mode_e_t brake_mode = pros::E_MOTOR_BRAKE_COAST;
+	pros::motor_encoder_units_e_t encoder_units = pros::E_MOTOR_ENCODER_DEGREES;
+	bool reversed = false;
+	Mode mode = Mode::voltage;
+	double target = 0;        // mV in voltage mode, gearset rpm otherwise
+	double target_position = 0; // reported degrees, position mode only
+	std::int32_t voltage_limit = 0;
+	std::int32_t current_limit = 2500;
+	double strength = 1;      // fraction of the nominal torque, for worn or hot motors
+	double stall_ratio = 1;   // back-EMF line stall torque over the current-limited stall
+
+	// Physical state of the output shaft, unaffected by the reversed flag.
+	double voltage = 0;       // mV
+	double velocity = 0;      // cartridge rpm
+	double position = 0;      // degrees
+	double torque = 0;        // N*m
+	double zero = 0;          // reported encoder offset, degrees
+	double temperature = 25;
+
+	// Set when a plant owns the shaft; unclaimed motors spin free.
+	bool claimed = false;
+	// Set on first use, so empty ports cost nothing per tick.
+	bool connected = false;
+
+	double free_rpm() const;
+	double stall_torque() const;
+	double direction() const;
+	double report_scale() const;
+
+	// Shaft torque for the current voltage at the given physical speed.
+	double torque_at(double rpm) const;
+	void update_voltage();
+};
+
+struct Rotation {
+	bool reversed = false;
+	std::uint32_t data_rate = 10;
+	double angle = 0;         // physical shaft angle, degrees
+	double zero = 0;          // reported position offset, centidegrees
+	double sample_angle = 0;  // angle latched at the last data_rate boundary
+	double sample_velocity = 0; // deg/s between the last two samples
+	bool connected = false;
+
+	double direction() const {
+		return reversed ? -1.0 : 1.0;
+	}
+};
+
+struct Imu {
+	bool present = false;     // a sensor is plugged in; otherwise reads fail
+	std::uint32_t data_rate = 10;
+	std::uint32_t calibrated_at = 0; // clock time reset() finishes, ms
+	double drift = 0;         // gyro bias, degrees per second
+	double scale = 1;         // gyro scale factor
+	double rotation = 0;      // integrated yaw, degrees clockwise, errors included
+	double rate = 0;          // yaw rate over the last tick, degrees per second
+	double zero = 0;          // reported rotation offset, degrees
+	double sample_rotation = 0; // rotation latched at the last data_rate boundary
+
+	// Feeds the gyro the body's true turn over one tick.
+	void turn(double degrees, double dt) {
+		rotation += scale * degrees;
+		rate = scale * degrees / dt;
+	}
+};
+
+// GPS fixes as the sensor reports them. A field plant fills them in.
+struct Gps {
+	bool present = false;     // a sensor is plugged in; otherwise reads fail
+	std::uint32_t data_rate = 20;
+	double x = 0;             // m from the field centre
+	double y = 0;
+	double heading = 0;       // degrees clockwise from +y
+	double error = 0.02;      // m, the sensor's own estimate
+	double offset_x = 0;      // m, as set through set_offset
+	double offset_y = 0;
+	double zero = 0;          // reported rotation offset, degrees
+};
+
+// Distance sensor readings. A field plant fills them in.
+struct Distance {
+	bool present = false;
+	std::int32_t range = 9999;  // mm, 9999 when nothing is in range
+	std::int32_t confidence = 0; // 0-63
+	std::int32_t size = 0;      // 0-400
+	double velocity = 0;        // m/s
+};
+
+struct Controller {
+	std::array<std::int32_t, 4> analog{};
+	std::array<bool, 18> digital{};
+	std::array<bool, 18> latched{};
+};
+
+class World;
+
+// A physical model stepped on every virtual millisecond. Plants read motor
+// voltages and write shaft and sensor state back into the world.
+class Plant {
+public:
+	virtual ~Plant() = default;
+	virtual void step(World& world, double dt) = 0;
+};
+
+class World {
+public:
+	World();
+	~World();
+	World(const World&) = delete;
+	World& operator=(const World&) = delete;
+
+	Kernel kernel;
+	std::array<Motor, 22> motors{};
+	std::array<Rotation, 22> rotations{};
+	std::array<Imu, 22> imus{};
+	std::array<Gps, 22> gpses{};
+	std::array<Distance, 22> distances{};
+	std::array<std::int32_t, 9> adi{};
+	std::array<Controller, 2> controllers{};
+	std::array<std::string, 8> lcd{};
+	bool lcd_echo = false;
+	bool autonomous = true;
+
+	template <class T, class... Args>
+	T& attach(Args&&... args) {
+		plants.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+		return static_cast<T&>(*plants.back());
+	}
+
+	Motor& motor(std::int8_t port);
+	Rotation& rotation(std::uint8_t port);
+	Imu& imu(std::uint8_t port);
+	Gps& gps(std::uint8_t port);
+	Distance& distance(std::uint8_t port);
+	std::int32_t& adi_port(std::uint8_t port);
+
+	// Runs the function on the host task until it returns or the clock reaches
+	// the timeout, then removes every task it started. Returns false on timeout.
+	bool run(const std::function<void()>& function, std::uint32_t timeout = UINT32_MAX);
+
+	inline std::uint32_t millis() const {
+		return kernel.millis();
+	}
+
+private:
+	std::vector<std::unique_ptr<Plant>> plants;
+	void tick(std::uint32_t now);
+};
+
+// The world owned by the calling thread. Aborts if there is none.
+World& world();
+bool has_world();
+
+}
@@ -0,0 +1,177 @@
+#include "squiggles.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Stand-in for the squiggles code okapilib links on the robot. It keeps the
+// interface and the shape of the output, not squiggles' exact numerics: each
+// pair of poses is joined by a quintic Hermite spline with tangents scaled to
+// the chord, and one forward and one backward pass over the whole path fit
+// the velocity to the model's constraints, starting and ending at rest.
+
+namespace squiggles {
+
+namespace {
+
+// Spline samples per cm of chord.
+constexpr double SAMPLES_PER_CM = 1;
+// Tangent length at each pose as a share of the chord.
+constexpr double TANGENT = 1.2;
+
+struct State {
+	Pose pose;
+	double curvature;
+	double distance;
+	double vel;
+	double time;
+};
+
+}
+
+QuinticPolynomial::QuinticPolynomial(double s_p, double s_v, double s_a, double g_p, double g_v, double g_a, double t) {
+	a0 = s_p;
+	a1 = s_v;
+	a2 = s_a / 2;
+	double t2 = t * t;
+	double t3 = t2 * t;
+	double t4 = t3 * t;
+	double t5 = t4 * t;
+	double c0 = g_p - a0 - a1 * t - a2 * t2;
+	double c1 = g_v - a1 - 2 * a2 * t;
+	double c2 = g_a - 2 * a2;
+	a3 = (10 * c0 - 4 * c1 * t + c2 * t2 / 2) / t3;
+	a4 = (-15 * c0 + 7 * c1 * t - c2 * t2) / t4;
+	a5 = (6 * c0 - 3 * c1 * t + c2 * t2 / 2) / t5;
+}
+
+double QuinticPolynomial::calc_point(double t) {
+	return a0 + t * (a1 + t * (a2 + t * (a3 + t * (a4 + t * a5))));
+}
+
+double QuinticPolynomial::calc_first_derivative(double t) {
+	return a1 + t * (2 * a2 + t * (3 * a3 + t * (4 * a4 + t * 5 * a5)));
+}
+
+double QuinticPolynomial::calc_second_derivative(double t) {
+	return 2 * a2 + t * (6 * a3 + t * (12 * a4 + t * 20 * a5));
+}
+
+double QuinticPolynomial::calc_third_derivative(double t) {
+	return 6 * a3 + t * (24 * a4 + t * 60 * a5);
+}
+
+SplineGenerator::SplineGenerator(Constraints iconstraints, std::shared_ptr<PhysicalModel> imodel, double idt)
+	: constraints(iconstraints), model(imodel), dt(idt) {
+}
+
+std::vector<ProfilePoint> SplineGenerator::generate(std::initializer_list<Pose> iwaypoints, bool fast) {
+	return generate(std::vector<Pose>(iwaypoints), fast);
+}
+
+std::vector<ProfilePoint> SplineGenerator::generate(std::vector<Pose> iwaypoints, bool) {
+	std::vector<State> states;
+	for (std::size_t i = 0; i + 1 < iwaypoints.size(); i++) {
+		auto& start = iwaypoints[i];
+		auto& end = iwaypoints[i + 1];
+		double chord = start.dist(end);
+		if (chord < K_EPSILON) {
+			continue;
+		}
+		double tangent = TANGENT * chord;
+		QuinticPolynomial x(start.x, tangent * std::cos(start.yaw), 0, end.x, tangent * std::cos(end.yaw), 0, 1);
+		QuinticPolynomial y(start.y, tangent * std::sin(start.yaw), 0, end.y, tangent * std::sin(end.yaw), 0, 1);
+
+		int samples = std::max(20, static_cast<int>(chord * SAMPLES_PER_CM));
+		for (int j = states.empty() ? 0 : 1; j <= samples; j++) {
+			double u = static_cast<double>(j) / samples;
+			double dx = x.calc_first_derivative(u);
+			double dy = y.calc_first_derivative(u);
+			double ddx = x.calc_second_derivative(u);
+			double ddy = y.calc_second_derivative(u);
+			double speed = std::hypot(dx, dy);
+			State state{Pose(x.calc_point(u), y.calc_point(u), std::atan2(dy, dx)),
+			            (dx * ddy - dy * ddx) / (speed * speed * speed), 0, 0, 0};
+			if (!states.empty()) {
+				state.distance = states.back().distance + state.pose.dist(states.back().pose);
+			}
+			states.push_back(state);
+		}
+	}
+	if (states.size() < 2) {
+		return {};
+	}
+
+	// The fastest each point allows, then held to what the robot can reach
+	// from the start and still stop from by the end.
+	for (auto& state : states) {
+		double limit = std::min(std::abs(state.curvature), constraints.max_curvature);
+		state.vel = model->constraints(state.pose, limit, constraints.max_vel).max_vel;
+	}
+	states.front().vel = 0;
+	states.back().vel = 0;
+	for (std::size_t i = 1; i < states.size(); i++) {
+		double ds = states[i].distance - states[i - 1].distance;
+		states[i].vel = std::min(states[i].vel, std::sqrt(states[i - 1].vel * states[i - 1].vel + 2 * constraints.max_accel * ds));
+	}
+	for (std::size_t i = states.size() - 1; i > 0; i--) {
+		double ds = states[i].distance - states[i - 1].distance;
+		states[i - 1].vel = std::min(states[i - 1].vel, std::sqrt(states[i].vel * states[i].vel - 2 * constraints.min_accel * ds));
+	}
+	for (std::size_t i = 1; i < states.size(); i++) {
+		double ds = states[i].distance - states[i - 1].distance;
+		double vel = states[i].vel + states[i - 1].vel;
+		states[i].time = states[i - 1].time + (vel > K_EPSILON ? 2 * ds / vel : 0);
+	}
+
+	std::vector<ProfilePoint> result;
+	std::size_t i = 1;
+	for (double t = 0;; t += dt) {
+		t = std::min(t, states.back().time);
+		while (i + 1 < states.size() && states[i].time < t) {
+			i++;
+		}
+		auto& a = states[i - 1];
+		auto& b = states[i];
+		double span = b.time - a.time;
+		double f = span > K_EPSILON ? (t - a.time) / span : 1;
+		double yaw = a.pose.yaw + std::remainder(b.pose.yaw - a.pose.yaw, 2 * M_PI) * f;
+		double vel = a.vel + (b.vel - a.vel) * f;
+		double accel = span > K_EPSILON ? (b.vel - a.vel) / span : 0;
+		double curvature = a.curvature + (b.curvature - a.curvature) * f;
+		result.emplace_back(ControlVector(Pose(a.pose.x + (b.pose.x - a.pose.x) * f, a.pose.y + (b.pose.y - a.pose.y) * f, yaw),
+		                                  vel, accel, 0),
+		                    model->linear_to_wheel_vels(vel, curvature), curvature, t);
+		if (t >= states.back().time) {
+			break;
+		}
+	}
+	return result;
+}
+
+TankModel::TankModel(double itrack_width, Constraints ilinear_constraints)
+	: track_width(itrack_width), linear_constraints(ilinear_constraints) {
+}
+
+Constraints TankModel::constraints(const Pose pose, double curvature, double vel) {
+	auto [min_accel, max_accel] = accel_constraint(pose, curvature, vel);
+	return Constraints(vel_constraint(pose, curvature, vel), max_accel, linear_constraints.max_jerk,
+	                   linear_constraints.max_curvature, min_accel);
+}
+
+std::vector<double> TankModel::linear_to_wheel_vels(double lin_vel, double curvature) {
+	return {lin_vel - lin_vel * curvature * track_width / 2, lin_vel + lin_vel * curvature * track_width / 2};
+}
+
+std::string TankModel::to_string() const {
+	return "TankModel {track_width: " + std::to_string(track_width) + ", " + linear_constraints.to_string() + "}";
+}
+
+// Slows the centre so the outside wheel stays within max_vel.
+double TankModel::vel_constraint(const Pose, double curvature, double vel) {
+	return std::min(vel, linear_constraints.max_vel / (1 + std::abs(curvature) * track_width / 2));
+}
+
+std::tuple<double, double> TankModel::accel_constraint(const Pose, double, double) const {
+	return {linear_constraints.min_accel, linear_constraints.max_accel};
+}
+
+}
@@ -0,0 +1,94 @@
+#include "robot.hpp"
+#include "paths.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+// Runs every path in paths.hpp through Robot::generate_trajectory, with the
+// chassis initialize() builds, and writes the profiles out as constexpr
+// fixed-point tables for Robot::follow_trajectory. The paths here are demos
+// for hbot_motion; copy a path's table into src/ to drive it in an auton.
+
+static std::int16_t quantise(double value, double scale, double& worst) {
+	double scaled = std::clamp(std::round(value * scale), -32768.0, 32767.0);
+	worst = std::max(worst, std::abs(scaled / scale - value));
+	return static_cast<std::int16_t>(scaled);
+}
+
+int main(int argc, char** argv) {
+	bool check = false;
+	const char* file = "trajectories.hpp";
+	for (int i = 1; i < argc; i++) {
+		if (!std::strcmp(argv[i], "--check")) {
+			check = true;
+		} else if (argv[i][0] != '-') {
+			file = argv[i];
+		} else {
+			std::fprintf(stderr, "usage: %s [--check] [file]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	std::vector<std::vector<squiggles::ProfilePoint>> profiles;
+	sim::World world;
+	sim::hbot_world(world);
+	world.run([&] {
+		initialize();
+		for (auto& path : PATHS) {
+			profiles.push_back(robot->generate_trajectory(path.poses, path.reverse, path.velocity, path.acceleration));
+		}
+	});
+	robot.reset();
+
+	std::ostringstream out;
+	out << "// Generated by sim/bin/hbot_trajectories from sim/paths.hpp; do not edit.\n"
+	    << "// Regenerate with `make -C sim trajectories`.\n"
+	    << "#pragma once\n"
+	    << "#include \"hbot.hpp\"\n"
+	    << "\n"
+	    << "namespace trajectories {\n";
+
+	std::printf("%-12s %9s %9s %9s %9s\n", "path", "points", "bytes", "s", "worst cm");
+	for (std::size_t p = 0; p < PATHS.size(); p++) {
+		auto& path = PATHS[p];
+		auto& profile = profiles[p];
+		double worst = 0;
+		double unused = 0;
+
+		out << "\ninline constexpr TrajectoryPoint " << path.name << "_POINTS[] = {";
+		for (std::size_t i = 0; i < profile.size(); i++) {
+			auto& point = profile[i];
+			out << (i % 4 == 0 ? "\n\t" : " ") << "{"
+			    << quantise(point.vector.pose.x, TrajectoryPoint::POSITION, worst) << ", "
+			    << quantise(point.vector.pose.y, TrajectoryPoint::POSITION, worst) << ", "
+			    << quantise(std::remainder(point.vector.pose.yaw, 2 * M_PI), TrajectoryPoint::YAW, unused) << ", "
+			    << quantise(point.vector.vel, TrajectoryPoint::VELOCITY, unused) << ", "
+			    << quantise(point.vector.accel, TrajectoryPoint::ACCELERATION, unused) << ", "
+			    << quantise(point.curvature, TrajectoryPoint::CURVATURE, unused) << "},";
+		}
+		out << "\n};\n"
+		    << "inline constexpr Trajectory " << path.name << " = {" << path.name << "_POINTS, " << profile.size()
+		    << ", " << Robot::TRAJECTORY_STEP << ", " << (path.reverse ? "true" : "false") << "};\n";
+
+		std::printf("%-12s %9zu %9zu %9.2f %9.3f\n", path.name, profile.size(), profile.size() * sizeof(TrajectoryPoint),
+		            profile.empty() ? 0 : profile.back().time, worst);
+	}
+	out << "\n}\n";
+
+	std::ifstream current(file);
+	std::stringstream existing;
+	existing << current.rdbuf();
+	if (existing.str() == out.str()) {
+		std::printf("%s is up to date\n", file);
+		return 0;
+	}
+	if (check) {
+		std::printf("%s is out of date\n", file);
+		return 1;
+	}
+	std::ofstream(file) << out.str();
+	std::printf("wrote %s\n", file);
+	return 0;
+}
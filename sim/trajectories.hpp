@@ -0,0 +1,113 @@
+// Generated by sim/bin/hbot_trajectories from sim/paths.hpp; do not edit.
+// Regenerate with `make -C sim trajectories`.
+#pragma once
+#include "hbot.hpp"
+
+namespace trajectories {
+
+inline constexpr TrajectoryPoint S_CURVE_POINTS[] = {
+	{0, 0, 0, 0, 2000, 0}, {2, 0, 1, 160, 2000, 20}, {4, 0, 3, 320, 2000, 39}, {6, 0, 4, 480, 2000, 59},
+	{8, 0, 6, 640, 2000, 79}, {10, 0, 7, 800, 2000, 98}, {12, 0, 9, 960, 2000, 118}, {14, 0, 10, 1120, 2000, 138},
+	{16, 0, 12, 1280, 2000, 157}, {18, 0, 13, 1440, 2000, 177}, {20, 0, 17, 1600, 2000, 202}, {25, 0, 27, 1760, 2000, 246},
+	{30, 0, 38, 1920, 2000, 291}, {34, 0, 48, 2080, 2000, 336}, {39, 0, 60, 2240, 2000, 383}, {45, 0, 83, 2400, 2000, 439},
+	{52, 0, 105, 2560, 2000, 495}, {58, 0, 128, 2720, 2000, 552}, {65, 0, 164, 2880, 2000, 617}, {72, 1, 200, 3040, 2000, 682},
+	{80, 1, 243, 3200, 2000, 750}, {88, 1, 295, 3360, 2000, 823}, {97, 1, 350, 3520, 2000, 898}, {106, 2, 419, 3680, 2000, 978},
+	{115, 2, 490, 3840, 2000, 1060}, {125, 3, 578, 4000, 2000, 1147}, {135, 4, 670, 4160, 2000, 1237}, {146, 5, 778, 4320, 2000, 1331},
+	{157, 6, 897, 4480, 2000, 1429}, {168, 7, 1025, 4640, 2000, 1530}, {180, 9, 1174, 4800, 2000, 1635}, {192, 11, 1335, 4960, 2000, 1742},
+	{204, 13, 1509, 5120, 2000, 1850}, {217, 15, 1704, 5280, 2000, 1960}, {230, 18, 1916, 5440, 2000, 2068}, {243, 22, 2143, 5532, 219, 2172},
+	{257, 25, 2382, 5526, -888, 2269}, {270, 29, 2629, 5456, -703, 2356}, {282, 34, 2883, 5400, -703, 2427}, {295, 39, 3142, 5356, -511, 2483},
+	{307, 44, 3403, 5325, -314, 2524}, {319, 50, 3667, 5307, -112, 2548}, {331, 55, 3931, 5301, 92, 2556}, {343, 62, 4196, 5308, 92, 2546},
+	{354, 68, 4459, 5332, 297, 2515}, {366, 76, 4719, 5368, 502, 2467}, {377, 83, 4976, 5418, 704, 2403}, {388, 91, 5227, 5481, 903, 2324},
+	{399, 99, 5473, 5558, 1098, 2230}, {410, 108, 5712, 5648, 1287, 2124}, {421, 118, 5942, 5751, 1471, 2005}, {431, 127, 6162, 5868, 1471, 1875},
+	{442, 138, 6371, 5999, 1650, 1737}, {453, 148, 6568, 6142, 1825, 1592}, {463, 160, 6752, 6299, 1997, 1441}, {474, 172, 6922, 6459, 2000, 1286},
+	{485, 184, 7076, 6619, 2000, 1127}, {496, 197, 7213, 6779, 2000, 967}, {506, 210, 7331, 6939, 2000, 804}, {517, 224, 7431, 7099, 2000, 640},
+	{528, 238, 7509, 7259, 2000, 475}, {539, 253, 7566, 7419, 2000, 309}, {551, 268, 7599, 7579, 2000, 140}, {562, 283, 7606, 7680, -2000, -31},
+	{573, 298, 7588, 7520, -2000, -202}, {585, 313, 7546, 7360, -2000, -370}, {596, 327, 7482, 7200, -2000, -536}, {607, 341, 7396, 7040, -2000, -700},
+	{618, 355, 7290, 6880, -2000, -864}, {628, 368, 7165, 6720, -2000, -1026}, {639, 381, 7021, 6560, -2000, -1186}, {650, 393, 6861, 6400, -2000, -1343},
+	{661, 404, 6686, 6240, -1997, -1497}, {671, 416, 6497, 6089, -1825, -1645}, {682, 426, 6295, 5951, -1650, -1788}, {693, 436, 6082, 5825, -1471, -1922},
+	{703, 446, 5858, 5713, -1287, -2048}, {714, 455, 5625, 5614, -1098, -2164}, {725, 464, 5385, 5527, -903, -2267}, {736, 472, 5137, 5455, -903, -2357},
+	{747, 480, 4882, 5398, -704, -2430}, {758, 487, 4624, 5354, -502, -2486}, {770, 494, 4362, 5323, -297, -2526}, {781, 501, 4099, 5305, -92, -2550},
+	{793, 507, 3834, 5301, 112, -2556}, {805, 513, 3570, 5310, 112, -2544}, {817, 518, 3307, 5334, 314, -2512}, {830, 523, 3047, 5371, 511, -2464},
+	{842, 528, 2791, 5420, 703, -2401}, {855, 532, 2539, 5481, 888, -2325}, {868, 536, 2292, 5554, 1064, -2235}, {882, 540, 2053, 5639, 1064, -2134},
+	{896, 543, 1823, 5736, 1233, -2022}, {910, 546, 1602, 5844, 1394, -1902}, {924, 549, 1390, 5962, 1548, -1776}, {939, 551, 1188, 6090, 1698, -1644},
+	{954, 553, 998, 6228, 1848, -1508}, {970, 555, 820, 6376, 2000, -1368}, {986, 556, 657, 6536, 2000, -1225}, {1003, 558, 509, 6696, 2000, -1079},
+	{1020, 558, 377, 6856, 2000, -929}, {1037, 559, 261, 7016, 2000, -776}, {1055, 560, 165, 7176, 2000, -619}, {1073, 560, 89, 7336, 2000, -455},
+	{1091, 560, 36, 7496, 2000, -282}, {1110, 560, 7, 7656, 2000, -98}, {1129, 560, -7, 7659, -2000, -94}, {1148, 560, -35, 7499, -2000, -279},
+	{1167, 560, -88, 7339, -2000, -452}, {1185, 560, -164, 7179, -2000, -616}, {1203, 559, -260, 7019, -2000, -774}, {1220, 558, -374, 6859, -2000, -927},
+	{1237, 558, -506, 6699, -2000, -1076}, {1254, 556, -654, 6539, -2000, -1223}, {1270, 555, -817, 6379, -2000, -1366}, {1285, 553, -995, 6230, -1848, -1506},
+	{1301, 551, -1185, 6092, -1698, -1642}, {1315, 549, -1386, 5964, -1548, -1774}, {1330, 546, -1598, 5846, -1394, -1900}, {1344, 543, -1819, 5738, -1233, -2020},
+	{1358, 540, -2050, 5640, -1064, -2132}, {1371, 536, -2288, 5555, -1064, -2234}, {1385, 532, -2535, 5482, -888, -2323}, {1398, 528, -2786, 5421, -703, -2400},
+	{1410, 523, -3043, 5372, -511, -2463}, {1423, 518, -3303, 5335, -314, -2511}, {1435, 513, -3565, 5310, -112, -2544}, {1447, 507, -3830, 5301, -112, -2556},
+	{1458, 501, -4095, 5305, 92, -2550}, {1470, 494, -4358, 5323, 297, -2527}, {1481, 487, -4620, 5353, 502, -2487}, {1493, 480, -4878, 5397, 704, -2431},
+	{1504, 472, -5133, 5454, 903, -2358}, {1515, 464, -5381, 5526, 903, -2269}, {1526, 455, -5621, 5612, 1098, -2165}, {1536, 446, -5854, 5711, 1287, -2050},
+	{1547, 436, -6078, 5823, 1471, -1925}, {1558, 426, -6292, 5948, 1650, -1790}, {1569, 416, -6494, 6086, 1825, -1648}, {1579, 405, -6683, 6238, 1997, -1499},
+	{1590, 393, -6859, 6397, 2000, -1346}, {1601, 381, -7019, 6557, 2000, -1188}, {1611, 368, -7162, 6717, 2000, -1028}, {1622, 355, -7288, 6877, 2000, -866},
+	{1633, 342, -7395, 7037, 2000, -703}, {1644, 328, -7481, 7197, 2000, -538}, {1655, 313, -7545, 7357, 2000, -372}, {1666, 298, -7587, 7517, 2000, -205},
+	{1678, 283, -7606, 7677, 2000, -34}, {1689, 268, -7599, 7581, -2000, 137}, {1700, 253, -7567, 7421, -2000, 306}, {1712, 238, -7510, 7261, -2000, 473},
+	{1723, 224, -7432, 7101, -2000, 638}, {1733, 210, -7333, 6941, -2000, 801}, {1744, 197, -7215, 6781, -2000, 964}, {1755, 184, -7078, 6621, -2000, 1125},
+	{1766, 172, -6925, 6461, -2000, 1283}, {1776, 160, -6755, 6301, -1997, 1438}, {1787, 149, -6571, 6145, -1825, 1589}, {1798, 138, -6374, 6001, -1650, 1734},
+	{1809, 128, -6166, 5870, -1471, 1873}, {1819, 118, -5946, 5753, -1471, 2003}, {1830, 108, -5716, 5649, -1287, 2122}, {1841, 100, -5477, 5559, -1098, 2229},
+	{1852, 91, -5231, 5483, -903, 2323}, {1863, 83, -4980, 5419, -704, 2402}, {1874, 76, -4723, 5369, -502, 2466}, {1885, 69, -4463, 5332, -297, 2515},
+	{1897, 62, -4200, 5308, -297, 2546}, {1909, 56, -3935, 5301, -92, 2556}, {1920, 50, -3671, 5306, 112, 2548}, {1933, 44, -3407, 5325, 314, 2524},
+	{1945, 39, -3146, 5356, 511, 2484}, {1957, 34, -2888, 5399, 703, 2428}, {1970, 30, -2634, 5455, 703, 2357}, {1983, 25, -2386, 5525, 888, 2270},
+	{1997, 22, -2147, 5532, -219, 2174}, {2010, 18, -1920, 5443, -2000, 2070}, {2023, 15, -1707, 5283, -2000, 1962}, {2036, 13, -1512, 5123, -2000, 1852},
+	{2048, 11, -1338, 4963, -2000, 1743}, {2060, 9, -1177, 4803, -2000, 1636}, {2072, 7, -1027, 4643, -2000, 1531}, {2083, 6, -899, 4483, -2000, 1431},
+	{2094, 5, -780, 4323, -2000, 1333}, {2105, 4, -672, 4163, -2000, 1238}, {2115, 3, -579, 4003, -2000, 1149}, {2125, 2, -491, 3843, -2000, 1061},
+	{2134, 2, -420, 3683, -2000, 980}, {2143, 1, -351, 3523, -2000, 899}, {2151, 1, -296, 3363, -2000, 825}, {2160, 1, -244, 3203, -2000, 752},
+	{2167, 1, -201, 3043, -2000, 683}, {2175, 0, -165, 2883, -2000, 618}, {2182, 0, -128, 2723, -2000, 553}, {2188, 0, -105, 2563, -2000, 496},
+	{2194, 0, -83, 2403, -2000, 440}, {2201, 0, -61, 2243, -2000, 383}, {2206, 0, -48, 2083, -2000, 337}, {2210, 0, -38, 1923, -2000, 292},
+	{2215, 0, -27, 1763, -2000, 247}, {2220, 0, -17, 1603, -2000, 202}, {2222, 0, -13, 1443, -2000, 177}, {2224, 0, -12, 1283, -2000, 158},
+	{2226, 0, -11, 1123, -2000, 138}, {2228, 0, -9, 963, -2000, 118}, {2230, 0, -8, 803, -2000, 99}, {2232, 0, -6, 643, -2000, 79},
+	{2234, 0, -5, 483, -2000, 59}, {2236, 0, -3, 323, -2000, 40}, {2238, 0, -2, 163, -2000, 20}, {2240, 0, 0, 3, -2000, 0},
+	{2240, 0, 0, 0, -2000, 0},
+};
+inline constexpr Trajectory S_CURVE = {S_CURVE_POINTS, 213, 0.01, false};
+
+inline constexpr TrajectoryPoint BACK_ARC_POINTS[] = {
+	{0, 0, 25736, 0, 2000, 0}, {-2, 0, -25735, 160, 2000, 8}, {-4, 0, -25735, 320, 2000, 15}, {-6, 0, -25734, 480, 2000, 23},
+	{-8, 0, -25734, 640, 2000, 30}, {-10, 0, -25733, 800, 2000, 38}, {-12, 0, -25732, 960, 2000, 46}, {-14, 0, -25732, 1120, 2000, 53},
+	{-16, 0, -25731, 1280, 2000, 61}, {-18, 0, -25731, 1440, 2000, 68}, {-20, 0, -25730, 1600, 2000, 78}, {-25, 0, -25725, 1760, 2000, 96},
+	{-30, 0, -25721, 1920, 2000, 113}, {-34, 0, -25717, 2080, 2000, 131}, {-39, 0, -25713, 2240, 2000, 149}, {-45, 0, -25704, 2400, 2000, 172},
+	{-52, 0, -25695, 2560, 2000, 194}, {-58, 0, -25686, 2720, 2000, 217}, {-65, 0, -25672, 2880, 2000, 243}, {-72, 0, -25657, 3040, 2000, 269},
+	{-80, 0, -25641, 3200, 2000, 296}, {-88, 0, -25620, 3360, 2000, 325}, {-97, -1, -25599, 3520, 2000, 355}, {-106, -1, -25571, 3680, 2000, 386},
+	{-115, -1, -25543, 3840, 2000, 418}, {-125, -1, -25508, 4000, 2000, 453}, {-135, -1, -25472, 4160, 2000, 487}, {-146, -2, -25429, 4320, 2000, 524},
+	{-157, -2, -25383, 4480, 2000, 562}, {-168, -3, -25331, 4640, 2000, 601}, {-180, -3, -25274, 4800, 2000, 642}, {-192, -4, -25212, 4960, 2000, 683},
+	{-205, -5, -25141, 5120, 2000, 727}, {-218, -6, -25065, 5280, 2000, 773}, {-231, -7, -24982, 5440, 2000, 820}, {-245, -9, -24892, 5600, 2000, 868},
+	{-259, -10, -24792, 5760, 2000, 919}, {-273, -12, -24684, 5920, 2000, 971}, {-288, -14, -24567, 6080, 2000, 1025}, {-303, -16, -24441, 6240, 2000, 1080},
+	{-319, -19, -24305, 6400, 2000, 1137}, {-335, -22, -24158, 6560, 2000, 1195}, {-351, -25, -24001, 6503, -735, 1253}, {-367, -29, -23839, 6439, -800, 1311},
+	{-382, -32, -23671, 6378, -762, 1367}, {-398, -37, -23499, 6319, -721, 1421}, {-413, -41, -23321, 6264, -677, 1473}, {-428, -46, -23138, 6212, -630, 1523},
+	{-442, -51, -22951, 6163, -580, 1570}, {-457, -56, -22760, 6118, -528, 1615}, {-471, -61, -22565, 6077, -473, 1656}, {-485, -67, -22367, 6040, -415, 1694},
+	{-498, -74, -22166, 6007, -356, 1727}, {-512, -80, -21962, 5979, -356, 1757}, {-525, -87, -21756, 5955, -294, 1782}, {-538, -94, -21548, 5936, -232, 1802},
+	{-551, -101, -21338, 5921, -169, 1818}, {-564, -109, -21127, 5911, -106, 1829}, {-576, -117, -20916, 5905, -43, 1836}, {-588, -126, -20704, 5903, 19, 1837},
+	{-600, -134, -20492, 5906, 80, 1834}, {-612, -143, -20281, 5913, 139, 1826}, {-624, -152, -20070, 5925, 195, 1814}, {-635, -162, -19861, 5940, 195, 1798},
+	{-646, -172, -19653, 5960, 249, 1777}, {-657, -182, -19448, 5983, 300, 1753}, {-667, -193, -19244, 6010, 348, 1725}, {-678, -204, -19043, 6040, 391, 1694},
+	{-688, -215, -18844, 6073, 431, 1661}, {-698, -226, -18649, 6108, 467, 1625}, {-708, -238, -18457, 6146, 498, 1587}, {-717, -250, -18268, 6186, 525, 1548},
+	{-727, -262, -18082, 6229, 548, 1507}, {-736, -275, -17901, 6272, 548, 1465}, {-745, -288, -17724, 6318, 567, 1422}, {-754, -301, -17550, 6364, 582, 1379},
+	{-762, -315, -17381, 6411, 593, 1336}, {-770, -329, -17216, 6459, 601, 1293}, {-778, -343, -17055, 6508, 605, 1250}, {-786, -357, -16898, 6556, 606, 1207},
+	{-794, -372, -16746, 6605, 605, 1166}, {-801, -386, -16597, 6653, 601, 1125}, {-809, -401, -16453, 6701, 594, 1084}, {-816, -417, -16313, 6748, 586, 1045},
+	{-822, -432, -16177, 6795, 586, 1007}, {-829, -448, -16046, 6841, 576, 970}, {-835, -464, -15919, 6886, 564, 934}, {-841, -480, -15795, 6931, 552, 899},
+	{-847, -496, -15675, 6974, 538, 866}, {-853, -513, -15559, 7017, 524, 834}, {-859, -530, -15447, 7058, 510, 802}, {-864, -546, -15338, 7098, 495, 772},
+	{-869, -563, -15232, 7138, 479, 743}, {-874, -581, -15130, 7176, 464, 716}, {-879, -598, -15032, 7213, 449, 689}, {-884, -615, -14936, 7249, 449, 663},
+	{-888, -633, -14844, 7284, 434, 639}, {-892, -651, -14755, 7317, 420, 615}, {-896, -669, -14668, 7350, 405, 592}, {-900, -687, -14585, 7382, 391, 570},
+	{-904, -705, -14504, 7412, 378, 550}, {-908, -723, -14426, 7442, 365, 529}, {-911, -741, -14350, 7471, 353, 510}, {-914, -760, -14277, 7499, 341, 491},
+	{-918, -778, -14206, 7526, 330, 473}, {-921, -797, -14137, 7552, 319, 456}, {-923, -816, -14071, 7578, 309, 440}, {-926, -834, -14007, 7602, 309, 424},
+	{-929, -853, -13945, 7626, 300, 408}, {-931, -872, -13886, 7650, 291, 393}, {-933, -891, -13828, 7673, 283, 379}, {-936, -910, -13772, 7695, 275, 365},
+	{-938, -929, -13718, 7716, 268, 351}, {-940, -949, -13666, 7738, 261, 338}, {-941, -968, -13616, 7758, 256, 325}, {-943, -987, -13568, 7779, 250, 312},
+	{-945, -1007, -13521, 7798, 245, 300}, {-946, -1026, -13476, 7818, 241, 288}, {-948, -1046, -13433, 7837, 237, 276}, {-949, -1065, -13392, 7856, 234, 265},
+	{-950, -1085, -13352, 7875, 231, 254}, {-951, -1105, -13314, 7889, -1033, 243}, {-952, -1124, -13277, 7806, -2000, 232}, {-953, -1143, -13243, 7646, -2000, 221},
+	{-954, -1162, -13211, 7486, -2000, 211}, {-955, -1181, -13182, 7326, -2000, 201}, {-955, -1199, -13154, 7166, -2000, 191}, {-956, -1217, -13128, 7006, -2000, 182},
+	{-957, -1234, -13104, 6846, -2000, 173}, {-957, -1251, -13082, 6686, -2000, 164}, {-957, -1267, -13061, 6526, -2000, 156}, {-958, -1283, -13042, 6366, -2000, 148},
+	{-958, -1299, -13024, 6206, -2000, 140}, {-958, -1314, -13008, 6046, -2000, 132}, {-959, -1329, -12993, 5886, -2000, 124}, {-959, -1344, -12979, 5726, -2000, 117},
+	{-959, -1358, -12967, 5566, -2000, 110}, {-959, -1372, -12956, 5406, -2000, 103}, {-959, -1385, -12945, 5246, -2000, 96}, {-959, -1398, -12936, 5086, -2000, 90},
+	{-960, -1410, -12927, 4926, -2000, 84}, {-960, -1422, -12920, 4766, -2000, 78}, {-960, -1434, -12913, 4606, -2000, 72}, {-960, -1446, -12906, 4446, -2000, 67},
+	{-960, -1456, -12901, 4286, -2000, 62}, {-960, -1467, -12896, 4126, -2000, 57}, {-960, -1477, -12892, 3966, -2000, 52}, {-960, -1487, -12888, 3806, -2000, 47},
+	{-960, -1496, -12885, 3646, -2000, 43}, {-960, -1505, -12882, 3486, -2000, 39}, {-960, -1513, -12880, 3326, -2000, 35}, {-960, -1522, -12877, 3166, -2000, 32},
+	{-960, -1529, -12876, 3006, -2000, 28}, {-960, -1536, -12874, 2846, -2000, 25}, {-960, -1544, -12873, 2686, -2000, 22}, {-960, -1550, -12872, 2526, -2000, 20},
+	{-960, -1556, -12871, 2366, -2000, 17}, {-960, -1562, -12870, 2206, -2000, 15}, {-960, -1567, -12870, 2046, -2000, 13}, {-960, -1571, -12869, 1886, -2000, 11},
+	{-960, -1576, -12869, 1726, -2000, 9}, {-960, -1581, -12868, 1566, -2000, 7}, {-960, -1583, -12868, 1406, -2000, 6}, {-960, -1585, -12868, 1246, -2000, 6},
+	{-960, -1587, -12868, 1086, -2000, 5}, {-960, -1589, -12868, 926, -2000, 4}, {-960, -1591, -12868, 766, -2000, 4}, {-960, -1593, -12868, 606, -2000, 3},
+	{-960, -1595, -12868, 446, -2000, 2}, {-960, -1596, -12868, 286, -2000, 1}, {-960, -1598, -12868, 126, -2000, 1}, {-960, -1600, -12868, 0, -2000, 0},
+};
+inline constexpr Trajectory BACK_ARC = {BACK_ARC_POINTS, 172, 0.01, true};
+
+}
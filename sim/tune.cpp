@@ -0,0 +1,518 @@
+#include "parallel.hpp"
+#include "random.hpp"
+#include "robot.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// Searches PID gains for the drive or turn controller against the drivetrain
+// model. Every candidate runs a fixed set of drive_dist_timeout or
+// turn_angle_timeout moves from initialize(), and is scored on the time each
+// move took, how far the robot really went past the target and where it
+// really came to rest. Candidates are simulated in parallel batches.
+
+constexpr std::size_t GAINS = 5;
+using Gains = std::array<double, GAINS>;
+const char* const NAMES[GAINS] = {"kp", "ki", "kd", "kb", "kf"};
+
+struct Score {
+	double cost;
+	double time;        // ms per move
+	double overshoot;   // worst move, cm or degrees
+	double error;       // mean final error, cm or degrees
+	std::uint32_t timeouts;
+	unsigned long interval;  // of the controller being tuned
+};
+
+struct Candidate {
+	Gains gains;
+	bool current;       // keep the gains from initialize()
+	Score score;
+};
+
+struct Task {
+	bool turn = false;
+	std::vector<double> moves;
+	unsigned long timeout = 4000;
+	unsigned long pause = 300;
+	double overshoot_weight = 0.1;  // seconds per cm or degree
+	double error_weight = 0.25;     // seconds per cm or degree
+};
+
+static Score evaluate(const Task& task, const Candidate& candidate) {
+	sim::World world;
+	auto& drive = sim::hbot_world(world);
+	std::vector<sim::Pose> trace;
+	struct Recorder : sim::Plant {
+		const sim::Drivetrain& drive;
+		std::vector<sim::Pose>& trace;
+		Recorder(const sim::Drivetrain& idrive, std::vector<sim::Pose>& itrace) : drive(idrive), trace(itrace) {
+		}
+		void step(sim::World&, double) override {
+			trace.push_back(drive.pose);
+		}
+	};
+	world.attach<Recorder>(drive, trace);
+
+	Score score{0, 0, 0, 0, 0, 0};
+	world.run([&] {
+		initialize();
+		if (!candidate.current) {
+			auto& controller = task.turn ? robot->controllers->turn : robot->controllers->drive;
+			auto& g = candidate.gains;
+			controller = PID::create(g[0], g[1], g[2], g[3], g[4], controller->get_interval());
+		}
+		score.interval = (task.turn ? robot->controllers->turn : robot->controllers->drive)->get_interval();
+		pros::delay(task.pause);
+
+		for (double target : task.moves) {
+			std::uint32_t start = pros::millis();
+			sim::Pose origin = drive.pose;
+			if (task.turn) {
+				robot->turn_angle_timeout(target, task.timeout);
+			} else {
+				robot->drive_dist_timeout(target, task.timeout);
+			}
+			std::uint32_t time = pros::millis() - start;
+			pros::delay(task.pause);
+
+			// Progress towards the target along the move, from the true pose.
+			auto progress = [&](const sim::Pose& pose) {
+				if (task.turn) {
+					return (pose.theta - origin.theta) * RADIAN_TO_DEGREE;
+				}
+				return (pose.x - origin.x) * std::cos(origin.theta) + (pose.y - origin.y) * std::sin(origin.theta);
+			};
+			double sign = target < 0 ? -1.0 : 1.0;
+			double overshoot = 0;
+			for (std::uint32_t t = start; t < trace.size(); t++) {
+				overshoot = std::max(overshoot, sign * (progress(trace[t]) - target));
+			}
+			double error = std::abs(progress(drive.pose) - target);
+
+			score.time += time / static_cast<double>(task.moves.size());
+			score.overshoot = std::max(score.overshoot, overshoot);
+			score.error += error / task.moves.size();
+			score.timeouts += time > task.timeout;
+			score.cost += (time / 1000.0 + task.overshoot_weight * overshoot + task.error_weight * error) /
+			              task.moves.size();
+		}
+	}, 10000 + task.moves.size() * (task.timeout + 2 * task.pause));
+
+	robot.reset();
+	return score;
+}
+
+// Gains live in the unit cube while searching; fixed gains have low == high.
+struct Space {
+	Gains low;
+	Gains high;
+	std::vector<std::size_t> free;
+
+	Gains gains(const std::vector<double>& unit) const {
+		Gains gains = low;
+		for (std::size_t i = 0; i < free.size(); i++) {
+			auto k = free[i];
+			gains[k] = low[k] + std::clamp(unit[i], 0.0, 1.0) * (high[k] - low[k]);
+		}
+		return gains;
+	}
+
+	std::vector<double> unit(const Gains& gains) const {
+		std::vector<double> unit;
+		for (auto k : free) {
+			unit.push_back((gains[k] - low[k]) / (high[k] - low[k]));
+		}
+		return unit;
+	}
+};
+
+class Tuner {
+	const Task& task;
+	const Space& space;
+	unsigned jobs;
+public:
+	std::vector<Candidate> evaluated;
+
+	Tuner(const Task& itask, const Space& ispace, unsigned ijobs) : task(itask), space(ispace), jobs(ijobs) {
+	}
+
+	std::vector<double> run(const std::vector<std::vector<double>>& points) {
+		std::vector<Candidate> batch;
+		for (auto& point : points) {
+			batch.push_back({space.gains(point), false, {}});
+		}
+		auto scores = sim::parallel_map<Score>(batch.size(), jobs, [&](std::size_t i) {
+			return evaluate(task, batch[i]);
+		});
+
+		std::vector<double> costs;
+		for (std::size_t i = 0; i < batch.size(); i++) {
+			batch[i].score = scores[i];
+			evaluated.push_back(batch[i]);
+			costs.push_back(scores[i].cost);
+		}
+		return costs;
+	}
+
+	void grid(std::size_t steps) {
+		std::size_t dims = space.free.size();
+		std::size_t total = 1;
+		for (std::size_t i = 0; i < dims; i++) {
+			total *= steps;
+		}
+
+		std::vector<std::vector<double>> points;
+		for (std::size_t n = 0; n < total; n++) {
+			std::vector<double> point(dims);
+			for (std::size_t i = 0, rest = n; i < dims; i++, rest /= steps) {
+				point[i] = steps > 1 ? static_cast<double>(rest % steps) / (steps - 1) : 0.5;
+			}
+			points.push_back(point);
+		}
+		run(points);
+	}
+
+	// Nelder-Mead in the unit cube. Reflection, expansion and both
+	// contractions are evaluated together each iteration so one batch fills
+	// the workers; a shrink evaluates the whole new simplex at once.
+	void nelder_mead(const std::vector<double>& start, std::size_t budget) {
+		std::size_t dims = start.size();
+		std::vector<std::vector<double>> simplex{start};
+		for (std::size_t i = 0; i < dims; i++) {
+			auto vertex = start;
+			vertex[i] += vertex[i] > 0.75 ? -0.25 : 0.25;
+			simplex.push_back(vertex);
+		}
+		auto costs = run(simplex);
+
+		while (evaluated.size() < budget) {
+			std::vector<std::size_t> order(simplex.size());
+			for (std::size_t i = 0; i < order.size(); i++) {
+				order[i] = i;
+			}
+			std::sort(order.begin(), order.end(), [&](auto a, auto b) { return costs[a] < costs[b]; });
+			std::size_t best = order.front(), worst = order.back(), second = order[order.size() - 2];
+
+			std::vector<double> centroid(dims, 0);
+			for (std::size_t v = 0; v < simplex.size(); v++) {
+				for (std::size_t i = 0; v != worst && i < dims; i++) {
+					centroid[i] += simplex[v][i] / dims;
+				}
+			}
+			auto along = [&](double t) {
+				std::vector<double> point(dims);
+				for (std::size_t i = 0; i < dims; i++) {
+					point[i] = std::clamp(centroid[i] + t * (simplex[worst][i] - centroid[i]), 0.0, 1.0);
+				}
+				return point;
+			};
+
+			std::vector<std::vector<double>> trials{along(-1), along(-2), along(-0.5), along(0.5)};
+			auto trial_costs = run(trials);
+			double reflected = trial_costs[0], expanded = trial_costs[1];
+			double outside = trial_costs[2], inside = trial_costs[3];
+
+			std::size_t accept = trials.size();
+			if (reflected < costs[best]) {
+				accept = expanded < reflected ? 1 : 0;
+			} else if (reflected < costs[second]) {
+				accept = 0;
+			} else if (reflected < costs[worst]) {
+				accept = outside <= reflected ? 2 : trials.size();
+			} else if (inside < costs[worst]) {
+				accept = 3;
+			}
+
+			if (accept < trials.size()) {
+				simplex[worst] = trials[accept];
+				costs[worst] = trial_costs[accept];
+				continue;
+			}
+
+			std::vector<std::vector<double>> shrunk;
+			for (std::size_t v = 0; v < simplex.size(); v++) {
+				if (v == best) {
+					continue;
+				}
+				for (std::size_t i = 0; i < dims; i++) {
+					simplex[v][i] = simplex[best][i] + 0.5 * (simplex[v][i] - simplex[best][i]);
+				}
+				shrunk.push_back(simplex[v]);
+			}
+			auto shrunk_costs = run(shrunk);
+			for (std::size_t v = 0, j = 0; v < simplex.size(); v++) {
+				if (v != best) {
+					costs[v] = shrunk_costs[j++];
+				}
+			}
+		}
+	}
+
+	// Bayesian optimisation with a Gaussian process surrogate (squared
+	// exponential kernel, fixed length scale) and expected improvement. Each
+	// round picks one well separated candidate per worker.
+	void bayesian(std::size_t budget, std::uint64_t seed) {
+		sim::Random rng(seed);
+		std::size_t dims = space.free.size();
+		auto random_point = [&] {
+			std::vector<double> point(dims);
+			for (auto& x : point) {
+				x = rng.uniform(0, 1);
+			}
+			return point;
+		};
+
+		std::vector<std::vector<double>> xs;
+		std::vector<double> ys;
+		auto add = [&](const std::vector<std::vector<double>>& points) {
+			auto costs = run(points);
+			for (std::size_t i = 0; i < points.size(); i++) {
+				xs.push_back(points[i]);
+				ys.push_back(std::log(costs[i]));
+			}
+		};
+
+		std::vector<std::vector<double>> initial;
+		for (std::size_t i = 0; i < std::max<std::size_t>(2 * dims + 2, budget / 5); i++) {
+			initial.push_back(random_point());
+		}
+		add(initial);
+
+		const double length = 0.2 * std::sqrt(static_cast<double>(dims));
+		auto kernel = [&](const std::vector<double>& a, const std::vector<double>& b) {
+			double d2 = 0;
+			for (std::size_t i = 0; i < dims; i++) {
+				d2 += (a[i] - b[i]) * (a[i] - b[i]);
+			}
+			return std::exp(-d2 / (2 * length * length));
+		};
+
+		while (evaluated.size() < budget) {
+			std::size_t n = xs.size();
+			double mean = 0, variance = 0;
+			for (double y : ys) {
+				mean += y / n;
+			}
+			for (double y : ys) {
+				variance += (y - mean) * (y - mean) / n;
+			}
+			variance = std::max(variance, 1e-9);
+
+			// Cholesky factor of the kernel matrix, then alpha = K^-1 (y - mean).
+			std::vector<double> chol(n * n, 0);
+			for (std::size_t i = 0; i < n; i++) {
+				for (std::size_t j = 0; j <= i; j++) {
+					double sum = kernel(xs[i], xs[j]) + (i == j ? 1e-4 : 0);
+					for (std::size_t k = 0; k < j; k++) {
+						sum -= chol[i * n + k] * chol[j * n + k];
+					}
+					chol[i * n + j] = i == j ? std::sqrt(std::max(sum, 1e-12)) : sum / chol[j * n + j];
+				}
+			}
+			auto solve_lower = [&](std::vector<double> b) {
+				for (std::size_t i = 0; i < n; i++) {
+					for (std::size_t k = 0; k < i; k++) {
+						b[i] -= chol[i * n + k] * b[k];
+					}
+					b[i] /= chol[i * n + i];
+				}
+				return b;
+			};
+			std::vector<double> centred(n);
+			for (std::size_t i = 0; i < n; i++) {
+				centred[i] = (ys[i] - mean) / std::sqrt(variance);
+			}
+			auto alpha = solve_lower(centred);
+			for (std::size_t i = n; i-- > 0;) {
+				for (std::size_t k = i + 1; k < n; k++) {
+					alpha[i] -= chol[k * n + i] * alpha[k];
+				}
+				alpha[i] /= chol[i * n + i];
+			}
+			double best = *std::min_element(ys.begin(), ys.end());
+			std::size_t best_index = std::min_element(ys.begin(), ys.end()) - ys.begin();
+
+			auto improvement = [&](const std::vector<double>& x) {
+				std::vector<double> k(n);
+				for (std::size_t i = 0; i < n; i++) {
+					k[i] = kernel(x, xs[i]);
+				}
+				double mu = 0;
+				for (std::size_t i = 0; i < n; i++) {
+					mu += k[i] * alpha[i];
+				}
+				auto v = solve_lower(k);
+				double var = 1;
+				for (double value : v) {
+					var -= value * value;
+				}
+				double sigma = std::sqrt(std::max(var, 1e-12)) * std::sqrt(variance);
+				mu = mean + mu * std::sqrt(variance);
+				double z = (best - mu) / sigma;
+				return (best - mu) * 0.5 * std::erfc(-z / std::sqrt(2)) + sigma * std::exp(-z * z / 2) / std::sqrt(2 * M_PI);
+			};
+
+			// Candidates are uniform samples plus local moves around the best point.
+			std::vector<std::pair<double, std::vector<double>>> pool;
+			for (int i = 0; i < 1500; i++) {
+				auto point = random_point();
+				if (i % 3 == 0) {
+					for (std::size_t d = 0; d < dims; d++) {
+						point[d] = std::clamp(xs[best_index][d] + (point[d] - 0.5) * 0.2, 0.0, 1.0);
+					}
+				}
+				pool.push_back({improvement(point), point});
+			}
+			std::sort(pool.begin(), pool.end(), [](auto& a, auto& b) { return a.first > b.first; });
+
+			std::vector<std::vector<double>> picked;
+			std::size_t want = std::min<std::size_t>(jobs, budget - evaluated.size());
+			for (auto& entry : pool) {
+				bool separated = true;
+				for (auto& other : picked) {
+					double d2 = 0;
+					for (std::size_t d = 0; d < dims; d++) {
+						d2 += (entry.second[d] - other[d]) * (entry.second[d] - other[d]);
+					}
+					separated &= d2 > 0.01;
+				}
+				if (separated) {
+					picked.push_back(entry.second);
+				}
+				if (picked.size() == want) {
+					break;
+				}
+			}
+			add(picked);
+		}
+	}
+};
+
+static bool parse_gains(const char* text, Gains& gains) {
+	return std::sscanf(text, "%lf,%lf,%lf,%lf,%lf", &gains[0], &gains[1], &gains[2], &gains[3], &gains[4]) == 5;
+}
+
+static void print_row(const char* label, const Gains* g, const Score& s, bool turn) {
+	const char* unit = turn ? "deg" : "cm";
+	if (g != nullptr) {
+		std::printf("%-12s %8.4g %8.4g %8.4g %8.4g %8.4g", label, (*g)[0], (*g)[1], (*g)[2], (*g)[3], (*g)[4]);
+	} else {
+		std::printf("%-12s %44s", label, "(as in src/main.cpp)");
+	}
+	std::printf(" %8.3f %7.0f ms %6.2f %-3s %6.2f %-3s %u\n", s.cost, s.time, s.overshoot, unit, s.error, unit,
+	            s.timeouts);
+}
+
+int main(int argc, char** argv) {
+	Task task;
+	std::string method = "nm";
+	std::size_t budget = 200;
+	std::size_t steps = 5;
+	std::size_t top = 10;
+	std::uint64_t seed = 1;
+	unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+	Gains low{0, 0, 0, 0, 0};
+	Gains high{1500, 20, 150, 1500, 0};
+	Gains start{};
+	bool has_start = false;
+	std::vector<double> moves;
+
+	for (int i = 1; i < argc; i++) {
+		if (!std::strcmp(argv[i], "drive") || !std::strcmp(argv[i], "turn")) {
+			task.turn = !std::strcmp(argv[i], "turn");
+		} else if (!std::strcmp(argv[i], "--method") && i + 1 < argc) {
+			method = argv[++i];
+		} else if (!std::strcmp(argv[i], "--budget") && i + 1 < argc) {
+			budget = std::atol(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--steps") && i + 1 < argc) {
+			steps = std::max(1l, std::atol(argv[++i]));
+		} else if (!std::strcmp(argv[i], "--low") && i + 1 < argc && parse_gains(argv[i + 1], low)) {
+			i++;
+		} else if (!std::strcmp(argv[i], "--high") && i + 1 < argc && parse_gains(argv[i + 1], high)) {
+			i++;
+		} else if (!std::strcmp(argv[i], "--start") && i + 1 < argc && parse_gains(argv[i + 1], start)) {
+			has_start = true;
+			i++;
+		} else if (!std::strcmp(argv[i], "--move") && i + 1 < argc) {
+			moves.push_back(std::atof(argv[++i]));
+		} else if (!std::strcmp(argv[i], "--timeout") && i + 1 < argc) {
+			task.timeout = std::atol(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--weights") && i + 1 < argc &&
+		           std::sscanf(argv[i + 1], "%lf,%lf", &task.overshoot_weight, &task.error_weight) == 2) {
+			i++;
+		} else if (!std::strcmp(argv[i], "--top") && i + 1 < argc) {
+			top = std::atol(argv[++i]);
+		} else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) {
+			seed = std::atol(argv[++i]);
+		} else if (!std::strcmp(argv[i], "-j") && i + 1 < argc) {
+			jobs = std::max(1, std::atoi(argv[++i]));
+		} else {
+			std::fprintf(stderr,
+			             "usage: %s drive|turn [--method grid|nm|bayes] [--budget n] [--steps n] [--low g] [--high g]\n"
+			             "       [--start g] [--move target]... [--timeout ms] [--weights overshoot,error] [--top n]\n"
+			             "       [--seed n] [-j jobs]\n"
+			             "where g is kp,ki,kd,kb,kf and a gain with equal low and high is held fixed\n", argv[0]);
+			return 2;
+		}
+	}
+
+	task.moves = !moves.empty() ? moves : task.turn ? std::vector<double>{90, -45, 180, -135}
+	                                                : std::vector<double>{60, -30, 120, -90};
+
+	Space space{low, high, {}};
+	for (std::size_t k = 0; k < GAINS; k++) {
+		if (high[k] > low[k]) {
+			space.free.push_back(k);
+		}
+	}
+	if (space.free.empty()) {
+		std::fprintf(stderr, "tune: every gain is fixed\n");
+		return 2;
+	}
+
+	auto wall_start = std::chrono::steady_clock::now();
+	Tuner tuner(task, space, jobs);
+	if (method == "grid") {
+		tuner.grid(steps);
+	} else if (method == "nm") {
+		tuner.nelder_mead(has_start ? space.unit(start) : std::vector<double>(space.free.size(), 0.5), budget);
+	} else if (method == "bayes") {
+		tuner.bayesian(budget, seed);
+	} else {
+		std::fprintf(stderr, "tune: unknown method %s\n", method.c_str());
+		return 2;
+	}
+	double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+
+	Candidate current{{}, true, {}};
+	current.score = sim::parallel_map<Score>(1, 1, [&](std::size_t) { return evaluate(task, current); }).at(0);
+
+	auto& ranked = tuner.evaluated;
+	std::sort(ranked.begin(), ranked.end(), [](auto& a, auto& b) { return a.score.cost < b.score.cost; });
+
+	std::printf("%s moves:", task.turn ? "turn" : "drive");
+	for (double move : task.moves) {
+		std::printf(" %g", move);
+	}
+	std::printf("\n%-12s %8s %8s %8s %8s %8s %8s %10s %10s %10s %s\n", "rank", NAMES[0], NAMES[1], NAMES[2],
+	            NAMES[3], NAMES[4], "cost", "time/move", "overshoot", "error", "timeouts");
+	print_row("initialize()", nullptr, current.score, task.turn);
+	for (std::size_t i = 0; i < std::min(top, ranked.size()); i++) {
+		print_row(std::to_string(i + 1).c_str(), &ranked[i].gains, ranked[i].score, task.turn);
+	}
+
+	std::printf("\n%zu candidates (%s) in %.2f s on %u workers\n", ranked.size(), method.c_str(), wall, jobs);
+	if (!ranked.empty()) {
+		auto& g = ranked.front().gains;
+		std::printf("PID::create(%.4g, %.4g, %.4g, %.4g, %.4g, %lu)\n", g[0], g[1], g[2], g[3], g[4],
+		            ranked.front().score.interval);
+	}
+	return 0;
+}
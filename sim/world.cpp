@@ -0,0 +1,197 @@
+#include "sim.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace sim {
+
+static thread_local World* current = nullptr;
+
+World& world() {
+	if (current == nullptr) {
+		std::fprintf(stderr, "sim: PROS call made outside of a sim::World\n");
+		std::abort();
+	}
+	return *current;
+}
+
+bool has_world() {
+	return current != nullptr;
+}
+
+double Motor::free_rpm() const {
+	switch (cartridge) {
+		case pros::E_MOTOR_GEARSET_36: return 100;
+		case pros::E_MOTOR_GEARSET_06: return 600;
+		default: return 200;
+	}
+}
+
+double Motor::stall_torque() const {
+	switch (cartridge) {
+		case pros::E_MOTOR_GEARSET_36: return 2.1;
+		case pros::E_MOTOR_GEARSET_06: return 0.35;
+		default: return 1.05;
+	}
+}
+
+double Motor::direction() const {
+	return reversed ? -1.0 : 1.0;
+}
+
+double Motor::report_scale() const {
+	double reported = 200;
+	switch (gearset) {
+		case pros::E_MOTOR_GEARSET_36: reported = 100; break;
+		case pros::E_MOTOR_GEARSET_06: reported = 600; break;
+		default: break;
+	}
+	return reported / free_rpm();
+}
+
+void Motor::update_voltage() {
+	double limit = voltage_limit > 0 ? std::min<double>(voltage_limit, 12000) : 12000;
+
+	double setpoint = target * direction() / report_scale();
+	if (mode == Mode::position) {
+		// Slow down linearly over the last 90 degrees of the move.
+		double remaining = (target_position + zero) * direction() / report_scale() - position;
+		setpoint = std::clamp(remaining / 90.0 * std::abs(setpoint), -std::abs(setpoint), std::abs(setpoint));
+	}
+
+	if (mode != Mode::voltage) {
+		// Rough stand-in for the motor's internal velocity loop.
+		double volts = (setpoint + 2.0 * (setpoint - velocity)) / free_rpm() * 12000.0;
+		voltage = setpoint == 0 ? 0 : std::clamp(volts, -limit, limit);
+	} else {
+		voltage = std::clamp(target * direction(), -limit, limit);
+	}
+}
+
+double Motor::torque_at(double rpm) const {
+	bool stopped = voltage == 0;
+	if (stopped && brake_mode == pros::E_MOTOR_BRAKE_COAST) {
+		return 0;
+	}
+
+	double stall = strength * stall_torque() * std::min(1.0, current_limit / 2500.0);
+	double torque = strength * stall_torque() * stall_ratio * (voltage / 12000.0 - rpm / free_rpm());
+	if (stopped && brake_mode == pros::E_MOTOR_BRAKE_HOLD) {
+		torque *= 2;
+	}
+	return std::clamp(torque, -stall, stall);
+}
+
+World::World() {
+	current = this;
+	kernel.on_tick = [this](std::uint32_t now) { tick(now); };
+}
+
+World::~World() {
+	if (kernel.current() == kernel.host()) {
+		kernel.remove_all();
+	}
+	if (current == this) {
+		current = nullptr;
+	}
+}
+
+Motor& World::motor(std::int8_t port) {
+	auto& motor = motors.at(std::abs(port));
+	motor.connected = true;
+	return motor;
+}
+
+Rotation& World::rotation(std::uint8_t port) {
+	auto& rotation = rotations.at(port);
+	rotation.connected = true;
+	return rotation;
+}
+
+Imu& World::imu(std::uint8_t port) {
+	return imus.at(port);
+}
+
+Gps& World::gps(std::uint8_t port) {
+	return gpses.at(port);
+}
+
+Distance& World::distance(std::uint8_t port) {
+	return distances.at(port);
+}
+
+std::int32_t& World::adi_port(std::uint8_t port) {
+	if (port >= 'a' && port <= 'h') {
+		port -= 'a' - 1;
+	} else if (port >= 'A' && port <= 'H') {
+		port -= 'A' - 1;
+	}
+	return adi.at(port);
+}
+
+bool World::run(const std::function<void()>& function, std::uint32_t timeout) {
+	kernel.deadline = timeout == UINT32_MAX ? UINT32_MAX : millis() + timeout;
+
+	bool finished = true;
+	try {
+		function();
+	} catch (const Timeout&) {
+		finished = false;
+	}
+
+	kernel.deadline = UINT32_MAX;
+	kernel.remove_all();
+	return finished;
+}
+
+void World::tick(std::uint32_t now) {
+	constexpr double dt = 0.001;
+
+	for (auto& motor : motors) {
+		if (motor.connected) {
+			motor.update_voltage();
+		}
+	}
+
+	for (auto& plant : plants) {
+		plant->step(*this, dt);
+	}
+
+	for (auto& motor : motors) {
+		if (motor.claimed || !motor.connected) {
+			continue;
+		}
+
+		// Unloaded shaft with a 40 ms mechanical time constant.
+		double free = motor.free_rpm() * 2 * M_PI / 60;
+		double inertia = motor.stall_torque() * 0.04 / free;
+		motor.torque = motor.torque_at(motor.velocity);
+		motor.velocity += motor.torque / inertia * dt * 60 / (2 * M_PI);
+		motor.position += motor.velocity * 6 * dt;
+	}
+
+	for (auto& imu : imus) {
+		if (!imu.present) {
+			continue;
+		}
+		imu.rotation += imu.drift * dt;
+		std::uint32_t rate = std::max<std::uint32_t>(imu.data_rate, 5);
+		if (now % rate == 0) {
+			imu.sample_rotation = imu.rotation;
+		}
+	}
+
+	for (auto& rotation : rotations) {
+		if (!rotation.connected) {
+			continue;
+		}
+		std::uint32_t rate = std::max<std::uint32_t>(rotation.data_rate, 5);
+		if (now % rate == 0) {
+			rotation.sample_velocity = (rotation.angle - rotation.sample_angle) / (rate / 1000.0);
+			rotation.sample_angle = rotation.angle;
+		}
+	}
+}
+
+}
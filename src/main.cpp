@@ -7,10 +7,38 @@
 std::unique_ptr<Robot> robot = nullptr;
 std::unique_ptr<Controller> controller = Controller::create(pros::Controller(pros::E_CONTROLLER_MASTER));
 
-constexpr int32_t FLYWHEEL_NORMAL_RPM = 1900;
-constexpr int32_t FLYWHEEL_ANGLECHG_RPM = 2000;
+// Distance the driver usually shoots from; drive_loop starts the flywheel at
+// the shot map's speeds for it.
+constexpr double DRIVER_DISTANCE = 140;  // cm
 constexpr int32_t FLYWHEEL_OVERFILL_RPM = 1900;
 
+// Goals in each auton's Odom frame, where the aim lines of its shots cross.
+constexpr double LEFT_GOAL_X = 257.9;
+constexpr double LEFT_GOAL_Y = -25.2;
+constexpr double RIGHT_GOAL_X = -144.4;
+constexpr double RIGHT_GOAL_Y = 278.4;
+constexpr double SOLO_GOAL_X = 275.2;
+constexpr double SOLO_GOAL_Y = -28.1;
+constexpr double SKILLS_GOAL_X = -90.1;
+constexpr double SKILLS_GOAL_Y = -320.7;
+
+// Drive model and tracking wheel trackwidth. Refit them with
+// auto_characterize, which prints these lines.
+constexpr double DRIVE_KS = 340;   // mV per side
+constexpr double DRIVE_KV = 67;    // mV per cm/s
+constexpr double DRIVE_KA = 18;    // mV per cm/s^2
+constexpr double TURN_KS = 1700;   // mV added to one side and taken from the other
+constexpr double TURN_KV = 980;    // mV per rad/s
+constexpr double TURN_KA = 250;    // mV per rad/s^2
+constexpr double TRACKING_WIDTH = 5.25 * INCH_TO_CM;
+// Fused into Odom's heading, which falls back to the tracking wheels if it
+// is unplugged or disagrees; auto_characterize measures TRACKING_WIDTH by it.
+constexpr std::uint8_t IMU_PORT = 7;
+// Between the drive wheels' contact lines, for move_curvature and trajectory
+// kinematics. 11.5 in is a placeholder, the sim drivetrain's default, until
+// it is measured on the robot.
+constexpr double DRIVE_WIDTH = 11.5 * INCH_TO_CM;
+
 void print_loop() {
 	while (true) {
 		auto pos = robot->controllers->odom->position();
@@ -19,6 +47,7 @@ void print_loop() {
 		pros::lcd::print(0, "X: %f cm", pos.x);
 		pros::lcd::print(1, "Y: %f cm", pos.y);
 		pros::lcd::print(2, "Heading: %f degrees", pos.heading);
+		pros::lcd::print(3, "Odom jitter: %.2f / %.2f ms", robot->controllers->odom->jitter(), robot->controllers->odom->max_jitter());
 		pros::lcd::print(4, "Flywheel: %f RPM", rpm);
 
 		pros::delay(20);
@@ -26,12 +55,13 @@ void print_loop() {
 }
 
 void drive_loop() {
-	robot->flywheel->move(FLYWHEEL_NORMAL_RPM);
+	int32_t flywheel_normal_rpm = robot->shot_map->rpm(DRIVER_DISTANCE, false);
+	int32_t flywheel_anglechg_rpm = robot->shot_map->rpm(DRIVER_DISTANCE, true);
+
+	robot->flywheel->move(flywheel_normal_rpm);
 	robot->flywheel->enable();
 	robot->chassis->set_brake_mode(pros::motor_brake_mode_e_t::E_MOTOR_BRAKE_COAST);
 
-	int32_t flywheel_normal_rpm = FLYWHEEL_NORMAL_RPM;
-	int32_t flywheel_anglechg_rpm = FLYWHEEL_ANGLECHG_RPM;
 	bool toggle_overfill = false;
 
 	while (true) {
@@ -75,7 +105,7 @@ void drive_loop() {
 			if (toggle_overfill) {
 				flywheel_anglechg_rpm = FLYWHEEL_OVERFILL_RPM;
 			} else {
-				flywheel_anglechg_rpm = FLYWHEEL_ANGLECHG_RPM;
+				flywheel_anglechg_rpm = robot->shot_map->rpm(DRIVER_DISTANCE, true);
 			}
 		}
 		
@@ -89,7 +119,7 @@ void fire_loop() {
             if(controller->pressed(DIGITAL_R2)) {
                 robot->indexer->index();
             } else {
-				robot->indexer->repeat(3);
+				robot->indexer->repeat_ready(3);
             }
         }
 		pros::delay(5);
@@ -109,14 +139,18 @@ void initialize() {
 		PID::create(400, 5, 45, 900, 0, 20),
 		PID::create(0, 0, 0, 0, 0, 20),
 		Odom::create(
-			pros::Rotation(8), pros::Rotation(6, true), 
-			2.75 * INCH_TO_CM, 5.25 * INCH_TO_CM)
+			pros::Rotation(8), pros::Rotation(6, true), pros::Imu(IMU_PORT),
+			2.75 * INCH_TO_CM, TRACKING_WIDTH, 10),
+		Feedforward::create(DRIVE_KS, DRIVE_KV, DRIVE_KA, 2),
+		Feedforward::create(TURN_KS, TURN_KV, TURN_KA, 0.2),
+		VelocityController::create(Feedforward::create(DRIVE_KS, DRIVE_KV, DRIVE_KA, 2), 40, 400),
+		VelocityController::create(Feedforward::create(DRIVE_KS, DRIVE_KV, DRIVE_KA, 2), 40, 400)
 	);
 
 	auto chassis = Chassis::create(
 		{19, -17, -18}, 
 		{-12,11, 13},
-		1, 1);
+		DRIVE_WIDTH, 1, 1);
 
 	auto intake = Intake::create(
 		{-1});
@@ -124,7 +158,8 @@ void initialize() {
 	auto flywheel = Flywheel::create(
 		{-10},
 		pros::Rotation(9),
-		PID::create(150, 0, 0, 895.0, 2.6, 10) // 
+		PID::create(150, 0, 0, 895.0, 2.6, 10), // 
+		StateSpace::create(0.97835, 0.00649, 123.6, 0.456, 0.028, 10.45, 0.65)
 		);
 
 	auto indexer = Indexer::create(
@@ -144,14 +179,19 @@ void initialize() {
 		std::move(flywheel),
 		std::move(indexer),
 		std::move(anglechg),
-		std::move(endgame));
+		std::move(endgame),
+		// Seeded from the speeds the autons used at each shot's distance;
+		// the angled table is the driver's 100 rpm offset. Refine on the field.
+		ShotMap::create(
+			{{140, 1900}, {160, 1950}, {200, 2150}, {250, 2300}, {270, 2400}, {300, 2440}},
+			{{140, 2000}, {160, 2050}, {200, 2250}, {250, 2400}, {270, 2500}, {300, 2540}}));
 }
 
 void auto_solo() {
 	// start flywheel
 	robot->flywheel->enable();
 	robot->flywheel->use_pidf();
-	robot->flywheel->move(2400); 
+	robot->aim_at(SOLO_GOAL_X, SOLO_GOAL_Y);
 
 	//get roller
 	robot->drive_dist_timeout(-7.5, 1000, 5);
@@ -160,9 +200,7 @@ void auto_solo() {
 	
 	//shoot preload
 	robot->turn_to_angle(-6);
-	pros::delay(1500);
-	robot->indexer->repeat(2, 300, 200);
-	robot->flywheel->move(2200);
+	robot->indexer->repeat_ready(2, 200);
 	
 
 	//bump line of 3
@@ -181,10 +219,7 @@ void auto_solo() {
 
 	//shoot line of 3
 	robot->turn_to_angle(-37.75);
-	robot->indexer->repeat(3, 300, 200);
-
-	//set for far 3 shots
-	robot->flywheel->move(2400);
+	robot->indexer->repeat_ready(3, 200);
 
 	//intake line of 3
 	robot->turn_to_angle(-140);
@@ -199,7 +234,7 @@ void auto_solo() {
 
 	//shoot 3
 	robot->turn_to_angle(-78.8);
-	robot->indexer->repeat(3, 325, 100);
+	robot->indexer->repeat_ready(3, 100);
 }
 
 void auto_left() {
@@ -208,7 +243,7 @@ void auto_left() {
 
 	robot->flywheel->enable();
 	robot->flywheel->use_pidf();
-	robot->flywheel->move(2340); 
+	robot->aim_at(LEFT_GOAL_X, LEFT_GOAL_Y);
 
 	//get roller
 	robot->drive_dist_timeout(-7.5, 1000, 5);
@@ -217,9 +252,7 @@ void auto_left() {
 	
 	//shoot preload
 	robot->turn_to_angle(-5.75);
-	pros::delay(1250);
-	robot->indexer->repeat(2, 300, 200);
-	robot->flywheel->move(2200);
+	robot->indexer->repeat_ready(2, 200);
 	
 	//bump line of 3
 	robot->turn_to_angle(-135);
@@ -240,9 +273,7 @@ void auto_left() {
 
 	//shoot line of 3
 	robot->turn_to_angle(-30.5);
-	robot->indexer->repeat(3, 300, 200);
-
-	robot->flywheel->move(2220);
+	robot->indexer->repeat_ready(3, 200);
 
 	//boomerang
 
@@ -253,7 +284,7 @@ void auto_left() {
 
 	//shoot line of 3
 	robot->turn_to_angle(-31.5);
-	robot->indexer->repeat(3, 300, 200);
+	robot->indexer->repeat_ready(3, 200);
 
 }
 
@@ -261,7 +292,7 @@ void auto_right() {
 	// start flywheel
 	robot->flywheel->enable();
 	robot->flywheel->use_pidf();
-	robot->flywheel->move(2440);
+	robot->aim_at(RIGHT_GOAL_X, RIGHT_GOAL_Y);
 	
 	// drive to roller
 	robot->drive_dist_timeout(-55, 750, true);
@@ -276,11 +307,8 @@ void auto_right() {
 
 	// turn to goal
 	robot->turn_to_angle(107.5);
-	pros::delay(350);
 	// shoot 2 preloads
-	robot->indexer->repeat(2, 500, 200);
-	// prepare lower flywheel velocity for next shots
-	robot->flywheel->move(2160);
+	robot->indexer->repeat_ready(2, 200);
 		
 	// start intake
 	robot->intake->move_voltage(12000);
@@ -296,8 +324,7 @@ void auto_right() {
 	robot->chassis->set_voltage_percent(100);
 
 	robot->turn_to_angle(140);
-	robot->indexer->repeat(3, 400, 200);
-	robot->flywheel->move(2160);
+	robot->indexer->repeat_ready(3, 200);
 	
 	// drive into boomerang
 	robot->drive_dist_timeout(-26, 1000, 7.5);
@@ -308,7 +335,7 @@ void auto_right() {
 	robot->turn_to_angle(141);
 	
 	// shoot
-	robot->indexer->repeat(3, 300, 200);
+	robot->indexer->repeat_ready(3, 200);
 
 	
 }
@@ -321,7 +348,7 @@ void auto_skills() {
 	
 	pros::delay(2750);
 
-	robot->indexer->repeat(9, 1000);
+	robot->indexer->repeat_ready(9);
 
 	// heading = 23.5
 	
@@ -345,14 +372,14 @@ void auto_skills() {
 	robot->drive_dist(-37.5, 5);
 	pros::delay(750);
 	robot->drive_to_point(-112.5, -95);
-	robot->indexer->repeat(1, 1000, 100);
+	robot->indexer->repeat_ready(1, 100);
 	robot->turn_to_angle(-218);
 	robot->chassis->set_voltage_percent(50);
 	robot->drive_to_point(12, -199, true);
 	
-	robot->flywheel->move(1950);
+	robot->aim_at(SKILLS_GOAL_X, SKILLS_GOAL_Y);
 	robot->turn_to_angle(-126);
-	robot->indexer->repeat(3, 1000, 100);
+	robot->indexer->repeat_ready(3, 100);
 
 	robot->turn_to_angle(-218);
 	robot->drive_dist(16.75);
@@ -361,13 +388,12 @@ void auto_skills() {
 	robot->drive_dist(-130);
 
 	robot->chassis->set_voltage_percent(80);
-	robot->flywheel->move(2000);
 
 	robot->turn_to_angle(-307);
 
 	robot->drive_to_point(-80.5, -138);
 	robot->turn_to_angle(-93);
-	robot->indexer->repeat(3, 1000, 100);
+	robot->indexer->repeat_ready(3, 100);
 
 	robot->chassis->set_voltage_percent(40);
 
@@ -379,10 +405,9 @@ void auto_skills() {
 
 	//robot->drive_to_point(-68.5, -98.5);
 
-	robot->flywheel->move(2100);
 	robot->drive_to_point(51.5, -174, true);
 	robot->turn_to_angle(-138);
-	robot->indexer->repeat(3, 1000, 100);
+	robot->indexer->repeat_ready(3, 100);
 
 	robot->chassis->set_voltage_percent(100);	
 	robot->drive_to_point(79.5, -156.25, true);
@@ -406,12 +431,65 @@ void auto_skills_old() {
 	
 }
 
+// Fits the drive model with Robot::characterize, driving straight and then
+// spinning in place, and prints the constants at the top of this file to
+// the terminal. Needs about 1.5 m clear ahead of the robot.
+void auto_characterize() {
+	pros::Imu imu(IMU_PORT);
+	imu.reset(true);
+	auto& odom = robot->controllers->odom;
+	// Odom's heading is fused with this IMU, so the wheels' own is worked
+	// out from their travel.
+	auto wheel_heading = [&] {
+		return (odom->left_position() - odom->right_position()) / odom->get_trackwidth() * RADIAN_TO_DEGREE;
+	};
+
+	// Every sample goes to the terminal too, for sim/fit_drive.py.
+	auto drive = robot->characterize(false, 120, 1000, 6000, 10, true);
+
+	// About two turns by the IMU, to see how far the wheels say it went.
+	double trackwidth = odom->get_trackwidth();
+	double imu_start = imu.get_rotation();
+	if (std::isfinite(imu_start)) {
+		double wheels_start = wheel_heading();
+		std::uint32_t start = pros::millis();
+		robot->chassis->move_tank(4000, -4000);
+		while (imu.get_rotation() - imu_start < 720 && pros::millis() - start < 10000) {
+			pros::delay(10);
+		}
+		robot->chassis->stop();
+		pros::delay(1000);
+		double turned = imu.get_rotation() - imu_start;
+		if (std::isfinite(turned) && turned > 360) {
+			trackwidth *= (wheel_heading() - wheels_start) / turned;
+		}
+	}
+
+	// The spins read the turn rate on Odom's trackwidth; rescale to the
+	// measured one so the turn model is per true rad/s.
+	auto turn = robot->characterize(true, 80, 1000, 6000, 10, true);
+	double scale = trackwidth / odom->get_trackwidth();
+	std::printf("[Characterize] trackwidth,%.4f,%.4f\n", trackwidth, odom->get_trackwidth());
+
+	if (drive) {
+		std::printf("constexpr double DRIVE_KS = %.4g;\nconstexpr double DRIVE_KV = %.4g;\nconstexpr double DRIVE_KA = %.4g;\n",
+		            drive->get_ks(), drive->get_kv(), drive->get_ka());
+	}
+	if (turn) {
+		std::printf("constexpr double TURN_KS = %.4g;\nconstexpr double TURN_KV = %.4g;\nconstexpr double TURN_KA = %.4g;\n",
+		            turn->get_ks(), turn->get_kv() * scale, turn->get_ka() * scale);
+	}
+	std::printf("constexpr double TRACKING_WIDTH = %.3f * INCH_TO_CM;\n", trackwidth / INCH_TO_CM);
+}
+
 void autonomous() {
 	pros::Task auto_(auto_left);
 	fire_loop();
 }
 
 void opcontrol() {
+	// An async motion the auton left running would fight the sticks.
+	robot->cancel();
 	pros::Task drive(drive_loop);
 	fire_loop();
 }